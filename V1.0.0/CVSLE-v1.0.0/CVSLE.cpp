@@ -28,6 +28,20 @@
  */
 
 #include "CVSLE.h"
+#include "CVSLETelemetry.h"
+#include "CVSLERecorder.h"
+
+#if (CVSLE_hookMode == 1)
+#include "CVSLEHooks.h"
+#endif
+
+#if (CVSLE_eventSystemMode == 1) && (CVSLE_telemetryMode == 1)
+#error "CVSLE_telemetryMode needs the zero-detect ISR, not available with CVSLE_eventSystemMode"
+#endif
+
+#if (CVSLE_eventSystemMode == 1) && (CVSLE_recorderMode == 1)
+#error "CVSLE_recorderMode needs the zero-detect ISR, not available with CVSLE_eventSystemMode"
+#endif
 
 
 //CVSLE Object
@@ -74,6 +88,211 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 	_absMotorFlag=false;
 	tempFlag=false;
 
+	_firingDelay=CVSLE_PTMAXTC;
+	_setpoint[0]=CVSLE_PTMAXTC;
+	_setpoint[1]=CVSLE_PTMAXTC;
+	_setpointIndex=0;
+
+#if (CVSLE_singleTimerMode == 1)
+	_ZDStamp=0;
+	_ZDStampPrev=0;
+#endif
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	//zero-detect calibration data members
+	_ZDParity=0;
+	_ZDOffset[0]=0;
+	_ZDOffset[1]=0;
+	_preRoll=false;
+
+#endif
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	//pulse train data members
+	_pulseCount=CVSLE_pulseCount;
+	_pulseWidth=CVSLE_pulseWidth;
+	_pulseSpacing=CVSLE_pulseSpacing;
+	_pulseIndex=0;
+	_pulseTime=0;
+
+#endif
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	//adaptive start data members
+	_currentLimit=CVSLE_currentLimit;
+	_currentPeak=0;
+	_currentPeakRun=0;
+	_currentOver=0;
+	_currentSampleReady=false;
+
+#endif
+
+#if (CVSLE_meteringMode == 1)
+
+	//metering data members
+	_meterRunning=false;
+	_meterVoltagePhase=true;
+	_meterVoltage=0;
+	_sumV2=0;
+	_sumI2=0;
+	_sumVI=0;
+	_samples=0;
+	_meterV2=0;
+	_meterI2=0;
+	_meterVI=0;
+	_meterN=0;
+	_energyAcc=0;
+
+#endif
+
+#if (CVSLE_scheduleMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	//half cycle count
+	_halfCycles=0;
+
+#endif
+
+#if (CVSLE_scheduleMode == 1)
+
+	//schedule data members
+	_scheduleCount=0;
+	_scheduleRun=false;
+
+#endif
+
+#if (CVSLE_thermalMode == 1)
+
+	//thermal model data members
+	_thermalConduction=0;
+	_thermalPeriod=0;
+	_thermalCycles=0;
+	_thermalRise=0;
+	_thermalAmbient=CVSLE_thermalAmbient;
+	_thermalDerate=100;
+	_thermalFloor=0;
+
+#if (CVSLE_meteringMode == 1)
+	_thermalRunI=0;
+	_thermalSumI=0;
+	_thermalSumI2=0;
+	_thermalSamples=0;
+#endif
+
+#endif
+
+#if (CVSLE_loadIDMode == 1)
+
+	//load identification data members
+	_loadType=CVSLE_loadUnknown;
+	_loadLag=0;
+	_loadMinTC=CVSLE_PTMINTC;
+	_gateWidth=CVSLE_triacDriverDelay;
+	_integralCycle=false;
+	_cycleHalf=0;
+	_cycleOn=false;
+	_cycleAcc=0;
+	_idRun=false;
+	_idSkip=false;
+	_idHalfCycles=0;
+	_idCycles=0;
+	_idLagRun=0;
+	_idPeakRun=0;
+	_idSum=0;
+	_idCount=0;
+	_idLagSum=0;
+	_idPeakSum=0;
+	_idEarly=0;
+	_idLate=0;
+
+#endif
+
+#if (CVSLE_timeBaseMode == 1)
+
+	//time base data members
+	_timeResidual=0;
+	_timeFallback=false;
+	_timeLocked=false;
+
+#endif
+
+#if (CVSLE_bypassMode == 1)
+
+	//bypass data members
+	_bypassState=CVSLE_bypassOpen;
+	_bypassCount=0;
+	_bypassStop=false;
+
+#endif
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//relay sync data members
+	_relayLevel=LOW;
+	_relayTarget=LOW;
+	_relayPending=false;
+	_relayArmed=false;
+	_relayMeasuring=false;
+	_relayFault=false;
+	_relayStamp=0;
+	_relayPeriods=0;
+	_relayRated[0]=cvsleDurationCast<CVSLETicks>(CVSLEMicros(CVSLE_relayReleaseUS)).count();
+	_relayRated[1]=cvsleDurationCast<CVSLETicks>(CVSLEMicros(CVSLE_relayOperateUS)).count();
+	_relayDelay[0]=_relayRated[0];
+	_relayDelay[1]=_relayRated[1];
+
+#endif
+
+#if (CVSLE_powerQualityMode == 1)
+
+	//power quality data members
+	_pqStarted=false;
+	_pqOverflows=0;
+	_pqWinN=0;
+	_pqWinSum=0;
+	_pqWinSq=0;
+	_pqWinMin=0xFFFF;
+	_pqWinMax=0;
+	_pqN=0;
+	_pqSum=0;
+	_pqSq=0;
+	_pqMin=0;
+	_pqMax=0;
+	_pqNPrev=0;
+	_pqSumPrev=0;
+	_pqDropouts=0;
+	_pqGlitches=0;
+	_pqDropoutMax=0;
+
+	for(byte i=0;i<CVSLE_pqBins;i++){
+
+		_pqHistogram[i]=0;
+
+	}//EOP bins
+
+#endif
+
+#if (CVSLE_threePhaseMode == 1)
+
+	//three phase data members
+	_ZDPhaseB=0;
+	_ZDPhaseC=0;
+	_phaseSeen=0;
+	_phaseStatus=CVSLE_phaseMissing;
+	_eventCount=0;
+	_eventIndex=0;
+
+#endif
+
+#if (CVSLE_eventSystemMode == 1)
+
+	//Event system backend, no timer ISRs
+	result=_eventSystemBegin();
+
+#else
+
 	//process timer init
 #if (CVSLE_ProcessTimer == 1)
 
@@ -84,6 +303,10 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 	_interruptMask_P=&TIMSK1;
 	_interruptflag_P=&TIFR1;
 
+#if (CVSLE_singleTimerMode == 1)
+	_outputCompareB_P=&OCR1B;
+#endif
+
 	result=1;
 
 
@@ -131,7 +354,18 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 
 
 	//ZD timer init
-#if (CVSLE_ZDTimer == 1)
+#if (CVSLE_singleTimerMode == 1)
+
+	//ZD period comes from timestamps on the process timer
+	_timerCounter_ZD=_timerCounter_P;
+	_outputCompare_ZD=_outputCompare_P;
+	_timerMode_ZD=_timerMode_P;
+	_prescaler_ZD=_prescaler_P;
+	_interruptMask_ZD=_interruptMask_P;
+	_interruptflag_ZD=_interruptflag_P;
+
+
+#elif (CVSLE_ZDTimer == 1)
 
 	_timerCounter_ZD=&TCNT1;
 	_outputCompare_ZD=&OCR1A;
@@ -182,6 +416,13 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 #else
 	result=0;
 
+#endif
+
+#if (CVSLE_recorderMode == 1)
+
+	//Keep a recording left by a reset, before any ISR can log
+	cvsRecorder.begin();
+
 #endif
 
 	//Check result
@@ -190,6 +431,21 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 		//Step 2 => Disable interrupts
 		noInterrupts();
 
+#if (CVSLE_singleTimerMode == 1)
+
+		//Step 3 => Setup shared timer, free running in normal mode
+		*_timerCounter_P=0;
+		*_outputCompare_P=0;
+		*_outputCompareB_P=0;
+		*_timerMode_P=0;
+		*_prescaler_P=0;
+		*_interruptMask_P=0;   // compare interrupts armed per half cycle
+		*_interruptflag_P=0xFF;   // clear pending flags
+
+		*_prescaler_P |= (1 << CS12);    // 256 prescaler, never stopped
+
+#else
+
 		//Step 3 => Setup process timer
 		*_timerCounter_P=0;
 		*_outputCompare_P=0;
@@ -216,6 +472,27 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 		*_interruptMask_ZD |= (1 << OCIE1A) | (1 << TOIE1);  // enable timer compare and overflow interrupt
 		*_prescaler_ZD |= (1 << CS12);    // 256 prescaler
 
+#endif
+
+#if (CVSLE_meteringMode == 1)
+
+		//Step 4a => Setup ADC for conversions chained from the ISR, first one started at zero-cross
+		_meterSelect(CVSLE_voltageChannel);
+		ADCSRA = (1 << ADEN) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);   // 128 prescaler
+
+#elif (CVSLE_adaptiveStartMode == 1)
+
+		//Step 4a => Setup ADC free running on current sensor channel
+		ADMUX = (1 << REFS0) | (CVSLE_currentChannel & 0x07);   // AVcc reference
+#if defined(MUX5)
+		ADCSRB = (CVSLE_currentChannel > 7) ? (1 << MUX5) : 0;   // free running trigger
+#else
+		ADCSRB = 0;   // free running trigger
+#endif
+		ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);   // 128 prescaler
+
+#endif
+
 		//Check pullup for interrupt
 		if(_inputPullupINT){
 
@@ -232,6 +509,26 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 		//Load relay pin
 		pinMode(_loadRelayPin,OUTPUT);
 
+#if (CVSLE_relaySyncMode == 1)
+
+		//Auxiliary contact times the relay on every switching
+		if(CVSLE_relaySensePin!=255){
+
+			pinMode(CVSLE_relaySensePin,INPUT_PULLUP);
+			attachInterrupt(digitalPinToInterrupt(CVSLE_relaySensePin), _relaySenseRoutine, CHANGE);
+
+		}//EOP sense pin used
+
+#endif
+
+#if (CVSLE_bypassMode == 1)
+
+		//Bypass contactor pin
+		pinMode(CVSLE_bypassPin,OUTPUT);
+		digitalWrite(CVSLE_bypassPin,LOW);
+
+#endif
+
 
 		//Attach zero detect interrupt
 		attachInterrupt(digitalPinToInterrupt(_interruptPin), _ZDRoutine, RISING);
@@ -245,6 +542,8 @@ byte CVSLE::begin(byte interruptPin, byte triacDriverPin, byte loadRelayPin, boo
 
 	}//EOP result NOK
 
+#endif
+
 	//Return statement
 	return result;
 
@@ -295,6 +594,15 @@ void CVSLE::setSoftStartInterval(byte softStartInterval){
 }//EOP setSoftStartInterval
 
 
+//setSoftStartInterval duration
+void CVSLE::setSoftStartInterval(CVSLESeconds softStartInterval){
+
+	//Clamp before narrowing, range checked by the seconds setter
+	setSoftStartInterval( (byte)( (softStartInterval.count()>CVSLE_softStartIntervalMax) ? CVSLE_softStartIntervalMax : softStartInterval.count() ) );
+
+}//EOP setSoftStartInterval
+
+
 //get load max %
 byte CVSLE::getLoadMax(){
 
@@ -363,37 +671,79 @@ void CVSLE::startLoadSoft(){
 	long TCMin=CVSLE_PTMAXTC-TCRange;
 	long TCMax=CVSLE_PTMAXTC;
 
+#if (CVSLE_adaptiveStartMode == 0)
+
 	//Step 3 => Calculate decrement period based on soft start interval
-	int TCP=(_softStartInterval*1000)/CVSLE_PTTCDIV;
+	unsigned long TCP=cvsleDurationCast<CVSLETimeUnit>(CVSLESeconds(_softStartInterval)).count()/CVSLE_PTTCDIV;
 
 	//Step 4 => Calculate TCIMin based on range
 	long TCIMin=TCRange/CVSLE_PTTCDIV;
 
+#endif
+
+#if (CVSLE_threePhaseMode == 1)
+
+	//Hold load OFF until all three phases are verified
+	if(_phaseStatus!=CVSLE_phaseOK){
+
+		stopLoad();
+
+		return;
+
+	}//EOP phase fault
+
+#endif
+
 	//Step 5 => Start interval polling
-	_currentLoadStart=millis();
+	_currentLoadStart=_timeNow();
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	//Step once per half cycle on a fresh current sample
+	bool stepDue=_currentSampleReady;
+	_currentSampleReady=false;
+
+#else
 
-	if( (_currentLoadStart-_previousLoadStart) > TCP){
+	bool stepDue=( (_currentLoadStart-_previousLoadStart) >= TCP );
+
+#endif
+
+	if(stepDue){
 
 		//Check interval counter
 		if(_softStartIntervalCount<CVSLE_PTTCDIV){
 
+#if (CVSLE_adaptiveStartMode == 1)
+
+			//Current limited step
+			_adaptiveStep(TCMin, TCMax);
+
+#else
+
 
 			//Reset interval polling
 			_previousLoadStart=_currentLoadStart;
 
-			//Change output compare register
-			*_outputCompare_P=*_outputCompare_P-TCIMin;
+			//Change firing delay, committed at next zero-cross
+			_firingDelay=_firingDelay-TCIMin;
 
 
 			//Increment interval counter
 			_softStartIntervalCount++;
 
+#endif
+
 
 		}//EOP Interval divisions count not reached
 		else{
 
 			//Check if output compare is close to CVSLE_PTMINTC
-			int outputC=*_outputCompare_P-CVSLE_PTMINTC;
+#if (CVSLE_loadIDMode == 1)
+			int outputC=_firingDelay-_loadMinTC;
+#else
+			int outputC=_firingDelay-CVSLE_PTMINTC;
+#endif
 
 			if( (outputC < CVSLE_PTABSMAXT) || (_motorMax==100) ){
 
@@ -421,21 +771,64 @@ void CVSLE::startLoadSoft(){
 
 	}//EOP check interval
 
+#if (CVSLE_thermalMode == 1)
+
+#if (CVSLE_scheduleMode == 1)
+
+	//Scheduled start calls from the ZD ISR, keep the float model out of it
+	if(!_scheduleRun)
+
+#endif
+
+	//Junction temperature and derating floor
+	_thermalStep();
+
+#endif
+
+	//Hand firing delay to the zero-detect ISR
+	_publishFiringDelay();
 
 	//Set motor status
 	motorStatus=true;
 
+#if (CVSLE_eventSystemMode == 1)
+
+	//Hand new firing delay to the hardware chain
+	_eventSystemApply();
+
+#endif
+
+#if (CVSLE_bypassMode == 1)
+
+	//Hand full load over to the bypass contactor, take it back below
+	_bypassRequest();
+
+#endif
+
+
+#if (CVSLE_pulseTrainMode == 0)
 
 	//Set triac driver trigger
+#if (CVSLE_bypassMode == 1)
+	if( _absMotorFlag && (_bypassState!=CVSLE_bypassClosed) ){
+#else
 	if(_absMotorFlag){
+#endif
 	
 		digitalWrite(_triacDriverPin, HIGH);
+
+#if (CVSLE_threePhaseMode == 1)
+		digitalWrite(_triacDriverPinB, HIGH);
+		digitalWrite(_triacDriverPinC, HIGH);
+#endif
 	
 	}//EOP trigger triac-driver only when ABSLoadMax reached
 
+#endif
+
 
 	//Set load relay enable
-	digitalWrite(_loadRelayPin,HIGH);
+	_relayWrite(HIGH);
 
 
 }//EOP startLoadSoft
@@ -444,30 +837,184 @@ void CVSLE::startLoadSoft(){
 //Stop load
 void CVSLE::stopLoad(){
 
+#if (CVSLE_recorderMode == 1)
+
+	//Keep the half cycles that led up to stopping a running load
+	if(motorStatus){
+
+		cvsRecorder.freeze(CVSLE_freezeStop);
+
+	}//EOP load was running
+
+#endif
 
 	//Reset all variables
-	_currentLoadStart=millis();
+	_currentLoadStart=_timeNow();
 	_previousLoadStart=_currentLoadStart;
 	_softStartIntervalCount=0;
-	*_outputCompare_P=CVSLE_PTMAXTC;    // Compare match register for little less than 10ms
+	_firingDelay=CVSLE_PTMAXTC;    // little less than 10ms, committed at next zero-cross
+	_publishFiringDelay();
 	motorMaxFlag=false;
 	motorStatus=false;
 	_absMotorFlag=false;
 
+#if (CVSLE_eventSystemMode == 1)
+	_eventSystemApply();
+#endif
+
+
+#if (CVSLE_bypassMode == 1)
+
+	//Variables, stopLoad may be called from the ZD ISR
+	uint8_t oldSREG=SREG;
+
+	noInterrupts();
+
+	if(_bypassState!=CVSLE_bypassOpen){
+
+		//Hand the load back to the triac first, gate and relay drop once the contactor is open
+		if(_bypassState!=CVSLE_bypassOpening){
+
+			_bypassState=CVSLE_bypassOpening;
+			_bypassCount=0;
+
+		}//EOP not opening yet
+
+		_bypassStop=true;
+
+		//Gate before the ISR can finish Opening and drop it
+		_gateWrite(HIGH);
+
+		SREG=oldSREG;
+
+		return;
+
+	}//EOP contactor made or moving
+
+	SREG=oldSREG;
+
+#endif
 
 	//Reset all output pins
 
 	//Reset triac driver trigger
 	digitalWrite(_triacDriverPin, LOW);
 
+#if (CVSLE_threePhaseMode == 1)
+	digitalWrite(_triacDriverPinB, LOW);
+	digitalWrite(_triacDriverPinC, LOW);
+#endif
 
 	//Reset load relay enable
-	digitalWrite(_loadRelayPin,LOW);
+	_relayWrite(LOW);
 
 
 }//EOP stopLoad
 
 
+//Publish firing delay
+void CVSLE::_publishFiringDelay(){
+
+	//Variables
+	byte next=_setpointIndex^1;
+	uint16_t delay=_firingDelay;
+
+#if (CVSLE_thermalMode == 1)
+
+	//Thermal derating holds firing delay at or above the floor
+	if(_thermalFloor>delay){
+
+		delay=_thermalFloor;
+		_absMotorFlag=false;
+
+	}//EOP derating
+
+#endif
+
+#if (CVSLE_loadIDMode == 1)
+
+	//Inductive loads fire past the measured current lag only
+	if(_loadMinTC>delay){
+
+		delay=_loadMinTC;
+
+	}//EOP below load min
+
+#endif
+
+	//Fill the buffer the ISR is not reading, then flip with a single byte write
+	_setpoint[next]=delay;
+	_setpointIndex=next;
+
+}//EOP _publishFiringDelay
+
+
+//Ramp and timeout clock
+unsigned long CVSLE::_timeNow(){
+
+#if (CVSLE_timeBaseMode == 1)
+
+	//Return
+	return getHalfCycleCount();
+
+#else
+
+	//Return
+	return millis();
+
+#endif
+
+}//EOP _timeNow
+
+
+//Load relay write
+void CVSLE::_relayWrite(byte level){
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Variables, stopLoad and scheduled starts call this from the ZD ISR
+	uint8_t oldSREG=SREG;
+
+	noInterrupts();
+
+	if( (level==LOW) && (_ZDCounter==0) ){
+
+		//No mains to time against, open at once
+		digitalWrite(_loadRelayPin,LOW);
+		_relayLevel=LOW;
+		_relayTarget=LOW;
+		_relayPending=false;
+		_relayArmed=false;
+
+	}//EOP no valid period
+	else if(level==_relayLevel){
+
+		//Already there, drop a command not yet given
+		_relayTarget=level;
+		_relayPending=false;
+		_relayArmed=false;
+
+	}//EOP no change
+	else if( (!_relayPending) || (_relayTarget!=level) ){
+
+		//Coil command armed at the next zero-cross
+		_relayTarget=level;
+		_relayPending=true;
+		_relayArmed=false;
+
+	}//EOP new target
+
+	SREG=oldSREG;
+
+#else
+
+	digitalWrite(_loadRelayPin,level);
+
+#endif
+
+}//EOP _relayWrite
+
+
 
 //startLoadSoft
 void CVSLE::startLoadHard(){
@@ -494,15 +1041,28 @@ void CVSLE::startLoadHard(){
 	long TCMax=CVSLE_PTMAXTC;
 
 	//Step 3 => Calculate decrement period based on soft start interval
-	int TCP=(CVSLE_hardStartInterval*1000)/CVSLE_PTTCDIV;
+	unsigned long TCP=cvsleDurationCast<CVSLETimeUnit>(CVSLESeconds(CVSLE_hardStartInterval)).count()/CVSLE_PTTCDIV;
 
 	//Step 4 => Calculate TCIMin based on range
 	long TCIMin=TCRange/CVSLE_PTTCDIV;
 
+#if (CVSLE_threePhaseMode == 1)
+
+	//Hold load OFF until all three phases are verified
+	if(_phaseStatus!=CVSLE_phaseOK){
+
+		stopLoad();
+
+		return;
+
+	}//EOP phase fault
+
+#endif
+
 	//Step 5 => Start interval polling
-	_currentLoadStart=millis();
+	_currentLoadStart=_timeNow();
 
-	if( (_currentLoadStart-_previousLoadStart) > TCP){
+	if( (_currentLoadStart-_previousLoadStart) >= TCP){
 
 		//Check interval counter
 		if(_softStartIntervalCount<CVSLE_PTTCDIV){
@@ -511,8 +1071,8 @@ void CVSLE::startLoadHard(){
 			//Reset interval polling
 			_previousLoadStart=_currentLoadStart;
 
-			//Change output compare register
-			*_outputCompare_P=*_outputCompare_P-TCIMin;
+			//Change firing delay, committed at next zero-cross
+			_firingDelay=_firingDelay-TCIMin;
 
 
 			//Increment interval counter
@@ -523,7 +1083,11 @@ void CVSLE::startLoadHard(){
 		else{
 
 			//Check if output compare is close to CVSLE_PTMINTC
-			int outputC=*_outputCompare_P-CVSLE_PTMINTC;
+#if (CVSLE_loadIDMode == 1)
+			int outputC=_firingDelay-_loadMinTC;
+#else
+			int outputC=_firingDelay-CVSLE_PTMINTC;
+#endif
 
 			if( (outputC < CVSLE_PTABSMAXT) || (_motorMax==100) ){
 
@@ -551,38 +1115,88 @@ void CVSLE::startLoadHard(){
 
 	}//EOP check interval
 
+#if (CVSLE_thermalMode == 1)
+
+#if (CVSLE_scheduleMode == 1)
+
+	//Scheduled start calls from the ZD ISR, keep the float model out of it
+	if(!_scheduleRun)
+
+#endif
+
+	//Junction temperature and derating floor
+	_thermalStep();
+
+#endif
+
+	//Hand firing delay to the zero-detect ISR
+	_publishFiringDelay();
 
 	//Set motor status
 	motorStatus=true;
 
+#if (CVSLE_eventSystemMode == 1)
 
-	//Set triac driver trigger
-	if(_absMotorFlag){
-	
-		digitalWrite(_triacDriverPin, HIGH);
-	
-	}//EOP trigger triac-driver only when ABSLoadMax reached
+	//Hand new firing delay to the hardware chain
+	_eventSystemApply();
 
+#endif
 
-	//Set load relay enable
-	digitalWrite(_loadRelayPin,HIGH);
+#if (CVSLE_bypassMode == 1)
 
+	//Hand full load over to the bypass contactor, take it back below
+	_bypassRequest();
 
-}//EOP startLoadHard
+#endif
 
 
-//getInputTimePeriod
-float CVSLE::getInputTimePeriod(){
+#if (CVSLE_pulseTrainMode == 0)
 
-	//Variables
+	//Set triac driver trigger
+#if (CVSLE_bypassMode == 1)
+	if( _absMotorFlag && (_bypassState!=CVSLE_bypassClosed) ){
+#else
+	if(_absMotorFlag){
+#endif
+	
+		digitalWrite(_triacDriverPin, HIGH);
+
+#if (CVSLE_threePhaseMode == 1)
+		digitalWrite(_triacDriverPinB, HIGH);
+		digitalWrite(_triacDriverPinC, HIGH);
+#endif
+	
+	}//EOP trigger triac-driver only when ABSLoadMax reached
+
+#endif
+
+
+	//Set load relay enable
+	_relayWrite(HIGH);
+
+
+}//EOP startLoadHard
+
+
+//getInputTimePeriod
+float CVSLE::getInputTimePeriod(){
+
+#if (CVSLE_eventSystemMode == 1)
+
+	//Latest period from TCB2
+	_eventSystemPeriod();
+
+#endif
+
+	//Variables
 	float result=0;
-	int tempDiff=_ZDCounter-624;
+	int tempDiff=_ZDCounter-(int)cvsleDurationCast<CVSLETicks>(CVSLEHalfCycles(1)).count();
 	int TCDiff=abs(tempDiff);
 
 	//Check TCDiff
 	if(TCDiff<50){
 
-		result=(_ZDCounter*10.0)/624.0;
+		result=cvsleDurationFloat<CVSLEMillis>(CVSLETicks(_ZDCounter));
 
 	}//EOP calC TP
 	else{
@@ -602,15 +1216,22 @@ float CVSLE::getInputTimePeriod(){
 //getInputFrequency
 float CVSLE::getInputFrequency(){
 
+#if (CVSLE_eventSystemMode == 1)
+
+	//Latest period from TCB2
+	_eventSystemPeriod();
+
+#endif
+
 	//Variables
 	float result=0;
-	int tempDiff=_ZDCounter-624;
+	int tempDiff=_ZDCounter-(int)cvsleDurationCast<CVSLETicks>(CVSLEHalfCycles(1)).count();
 	int TCDiff=abs(tempDiff);
 
 	//Check TCDiff
 	if(TCDiff<50){
 
-		float TCP=(_ZDCounter*10.0)/624.0;
+		float TCP=cvsleDurationFloat<CVSLEMillis>(CVSLETicks(_ZDCounter));
 
 		result=1000.0/(TCP*2.0);
 
@@ -628,291 +1249,3522 @@ float CVSLE::getInputFrequency(){
 }//EOP getInputFrequency
 
 
+//getStateBits
+byte CVSLE::getStateBits(){
 
+	//Variables
+	byte result=0;
 
-//****************************
-//  Interrupt Function
-//****************************
+	if(motorStatus){
 
-//process timer init
-#if (CVSLE_ProcessTimer == 1)
+		result|=CVSLE_stateMotor;
 
-//Compare ISR
-ISR(TIMER1_COMPA_vect){
+	}//EOP motor on
 
-	//Compare routine
-	cvsLE.compareInterruptRoutine();
+	if(motorMaxFlag){
 
+		result|=CVSLE_stateMotorMax;
 
-}//EOP compare ISR
+	}//EOP motor max
 
+	if(_absMotorFlag){
 
-//Overflow ISR
-ISR(TIMER1_OVF_vect){
+		result|=CVSLE_stateAbsMax;
 
-	//Overflow routine
-	cvsLE.overflowInterruptRoutine();
+	}//EOP abs max
 
-}//EOP overflow ISR
+#if (CVSLE_ZDCalibrationMode == 1)
 
-#elif (CVSLE_ProcessTimer == 3)
+	if(_ZDParity){
 
-//Compare ISR
-ISR(TIMER3_COMPA_vect){
+		result|=CVSLE_stateOddHalf;
 
-	//Compare routine
-	cvsLE.compareInterruptRoutine();
+	}//EOP odd half cycle
 
-}//EOP compare ISR
+#endif
 
+#if (CVSLE_bypassMode == 1)
 
-//Overflow ISR
-ISR(TIMER3_OVF_vect){
+	if(_bypassState==CVSLE_bypassClosed){
 
-	//Overflow routine
-	cvsLE.overflowInterruptRoutine();
+		result|=CVSLE_stateBypass;
 
-}//EOP overflow ISR
+	}//EOP bypass closed
+
+#endif
 
+	//Return
+	return result;
 
+}//EOP getStateBits
 
-#elif (CVSLE_ProcessTimer == 4)
 
-//Compare ISR
-ISR(TIMER4_COMPA_vect){
+//getFaultBits
+byte CVSLE::getFaultBits(){
 
-	//Compare routine
-	cvsLE.compareInterruptRoutine();
+	//Variables
+	byte result=0;
 
-}//EOP compare ISR
+	if(_ZDCounter==0){
 
+		result|=CVSLE_faultZDPeriod;
 
-//Overflow ISR
-ISR(TIMER4_OVF_vect){
+	}//EOP no valid period
 
-	//Overflow routine
-	cvsLE.overflowInterruptRoutine();
+#if (CVSLE_threePhaseMode == 1)
 
-}//EOP overflow ISR
+	if(_phaseStatus!=CVSLE_phaseOK){
 
+		result|=CVSLE_faultPhase;
 
+	}//EOP phase fault
 
-#elif (CVSLE_ProcessTimer == 5)
+#endif
 
-//Compare ISR
-ISR(TIMER5_COMPA_vect){
+#if (CVSLE_adaptiveStartMode == 1)
 
-	//Compare routine
-	cvsLE.compareInterruptRoutine();
+	//Single half cycles above the limit are adaptive hold back, not a fault
+	if(_currentOver>=CVSLE_currentTripCycles){
 
-}//EOP compare ISR
+		result|=CVSLE_faultCurrent;
 
+	}//EOP over current
 
-//Overflow ISR
-ISR(TIMER5_OVF_vect){
+#endif
 
-	//Overflow routine
-	cvsLE.overflowInterruptRoutine();
+#if (CVSLE_relaySyncMode == 1)
 
-}//EOP overflow ISR
+	if(_relayFault){
 
+		result|=CVSLE_faultRelay;
+
+	}//EOP relay fault
 
 #endif
 
+	//Return
+	return result;
 
-//ZD timer init
-#if (CVSLE_ZDTimer == 1)
+}//EOP getFaultBits
 
-//Compare ISR
-ISR(TIMER1_COMPA_vect){
 
+#if (CVSLE_scheduleMode == 1)
 
-}//EOP compare ISR
+#if (CVSLE_timeBaseMode == 0)
 
+//get half cycle count
+uint32_t CVSLE::getHalfCycleCount(){
 
-//Overflow ISR
-ISR(TIMER1_OVF_vect){
+	//Variables
+	uint32_t result=0;
 
+	noInterrupts();
+	result=_halfCycles;
+	interrupts();
 
+	//Return
+	return result;
 
-}//EOP overflow ISR
+}//EOP getHalfCycleCount
 
+#endif
 
 
-#elif (CVSLE_ZDTimer == 3)
+//Schedule action at half cycle count
+byte CVSLE::scheduleAt(uint32_t halfCycle, byte action, byte value){
 
-//Compare ISR
-ISR(TIMER3_COMPA_vect){
+	//Variables
+	byte result=0;
 
+	//Check action
+	if( (action<CVSLE_actionStart) || (action>CVSLE_actionLoadMax) ){
 
-}//EOP compare ISR
+		return result;
 
+	}//EOP bad action
 
-//Overflow ISR
-ISR(TIMER3_OVF_vect){
+	noInterrupts();
 
+	//Check queue
+	if(_scheduleCount<CVSLE_scheduleSlots){
 
+		//Variables
+		byte j=_scheduleCount;
+		uint32_t now=_halfCycles;
 
-}//EOP overflow ISR
+		//Shift later actions up, equal times keep call order
+		while( (j>0) && ( (int32_t)(_scheduleTime[j-1]-now) > (int32_t)(halfCycle-now) ) ){
 
+			_scheduleTime[j]=_scheduleTime[j-1];
+			_scheduleAction[j]=_scheduleAction[j-1];
+			_scheduleValue[j]=_scheduleValue[j-1];
 
+			j--;
 
-#elif (CVSLE_ZDTimer == 4)
+		}//EOP shift later actions
 
-//Compare ISR
-ISR(TIMER4_COMPA_vect){
+		_scheduleTime[j]=halfCycle;
+		_scheduleAction[j]=action;
+		_scheduleValue[j]=value;
 
+		_scheduleCount++;
 
-}//EOP compare ISR
+		result=1;
 
+	}//EOP slot free
 
-//Overflow ISR
-ISR(TIMER4_OVF_vect){
+	interrupts();
 
+	//Return
+	return result;
 
+}//EOP scheduleAt
 
-}//EOP overflow ISR
 
+//Schedule action after half cycles
+byte CVSLE::scheduleAfter(uint32_t halfCycles, byte action, byte value){
 
+	//Return
+	return scheduleAt(getHalfCycleCount()+halfCycles, action, value);
 
-#elif (CVSLE_ZDTimer == 5)
+}//EOP scheduleAfter
 
-//Compare ISR
-ISR(TIMER5_COMPA_vect){
 
+//scheduleAfter duration
+byte CVSLE::scheduleAfter(CVSLEHalfCycles delay, byte action, byte value){
 
-}//EOP compare ISR
+	//Return
+	return scheduleAfter(delay.count(), action, value);
 
+}//EOP scheduleAfter
 
-//Overflow ISR
-ISR(TIMER5_OVF_vect){
 
+//Clear schedule
+void CVSLE::clearSchedule(){
 
+	noInterrupts();
+	_scheduleCount=0;
+	interrupts();
 
-}//EOP overflow ISR
+}//EOP clearSchedule
 
 
-#endif
+//get schedule count
+byte CVSLE::getScheduleCount(){
 
+	//Variables
+	byte result=0;
 
+	result=_scheduleCount;
 
-//Set compare attach routine to default
-void (*CVSLE::isrCompare)()= CVSLE::isrDefaultUnused;
+	//Return
+	return result;
 
-//Set overflow attach routine to default
-void (*CVSLE::isrOverflow)()= CVSLE::isrDefaultUnused;
+}//EOP getScheduleCount
 
-//Default function
-void CVSLE::isrDefaultUnused()
-{
-}
 
+//get scheduled run
+bool CVSLE::getScheduledRun(){
 
-//Static wrapper for ZD
-void CVSLE::_ZDRoutine()
+	//Variables
+	bool result=false;
+
+	result=_scheduleRun;
+
+	//Return
+	return result;
+
+}//EOP getScheduledRun
+
+
+//Run schedule
+void CVSLE::_runSchedule()
 {
 
-	//check motorStatus flag
-	if(cvsLE.motorStatus){
+#if (CVSLE_timeBaseMode == 0)
 
-		//Process ISR
-		cvsLE.zeroDetectISR();
+	//Step 1 => Count half cycle, the time base has counted it otherwise
+	_halfCycles++;
 
-	}//EOP Load in ON
-	else{
+#endif
 
-		//Reset prescaler and stop timer
-		*cvsLE._prescaler_P=0;
+	//Step 2 => Run due actions, queue is sorted so only the head is checked
+	while( (_scheduleCount>0) && ( (int32_t)(_halfCycles-_scheduleTime[0]) >= 0 ) ){
 
-		//Reset counter value
-		*cvsLE._timerCounter_P=0;
+		//Variables
+		byte action=_scheduleAction[0];
+		byte value=_scheduleValue[0];
 
-	}//EOP load is OFF
+		//Pop head
+		_scheduleCount--;
 
+		for(byte i=0;i<_scheduleCount;i++){
 
-	//ZD ISR
-	cvsLE.ZDTimerCalC();
+			_scheduleTime[i]=_scheduleTime[i+1];
+			_scheduleAction[i]=_scheduleAction[i+1];
+			_scheduleValue[i]=_scheduleValue[i+1];
 
-}
+		}//EOP shift down
 
-//Zero detect interrupt routine
-void CVSLE::zeroDetectISR()
-{
+		//Execute
+		if(action==CVSLE_actionStart){
 
-	//Set prescaler and start timer
-	*_prescaler_P=0;
-	*_prescaler_P=(1 << CS12);
+			_scheduleRun=true;
 
-	//Reset counter value
-	*_timerCounter_P=0;
+		}//EOP start
+		else if(action==CVSLE_actionStop){
 
+			_scheduleRun=false;
 
-}//EOP zeroDetectISR
+			stopLoad();
 
+		}//EOP stop
+		else{
 
+			_applyLoadMax(value);
 
-//Routine for ZD Timer
-void CVSLE::ZDTimerCalC()
-{
+		}//EOP load max
 
-	//ZD Timer
-	_ZDCounter=*_timerCounter_ZD;
+	}//EOP due actions
 
-	//Check zd-Counter
-	if(_ZDCounter>CVSLE_ZDMTC){
+	//Step 3 => Ramp the scheduled run, one poll per half cycle
+	if(_scheduleRun){
 
-		//Set ZDcounter to zero
-		_ZDCounter=0;
+		startLoadSoft();
 
-	}//EOP greater than required count
+	}//EOP scheduled run
 
-	//Reset ZD Counter
-	*_timerCounter_ZD=0;
+}//EOP _runSchedule
 
 
-}//EOP zeroDetectISR
+//Apply load max
+void CVSLE::_applyLoadMax(byte motorMax){
 
+	//Step 1 => Clamp like setLoadMax
+	if(motorMax>CVSLE_loadMaxPercent){
 
+		motorMax=CVSLE_loadMaxPercent;
 
+	}//EOP beyond max limit
+	else if(motorMax<CVSLE_loadMinPercent){
 
-//compareInterruptRoutine
-void CVSLE::compareInterruptRoutine()
-{
+		motorMax=CVSLE_loadMinPercent;
 
-	//Set triacDriver High
-	digitalWrite(_triacDriverPin, HIGH);
+	}//EOP below min limit
 
+	_motorMax=motorMax;
 
-	//Call user defined routine
-	isrCompare();
+	//Step 2 => Running load moves to the same ramp step on the new range
+	if(motorStatus){
 
+		long TCRange=(((long)CVSLE_PTMAXTC-(long)CVSLE_PTMINTC)*_motorMax)/100;
 
-	//Set counter value close to overflow to switch off triacDriver pulse
-	*_timerCounter_P=CVSLE_PTimerMax-CVSLE_triacDriverDelay;
+		_firingDelay=CVSLE_PTMAXTC-((TCRange/CVSLE_PTTCDIV)*_softStartIntervalCount);
+		_publishFiringDelay();
 
+	}//EOP load running
 
-}//EOP compareInterruptRoutine
+}//EOP _applyLoadMax
 
-//overflowInterruptRoutine
-void CVSLE::overflowInterruptRoutine()
-{
+#endif
 
-	//Check absolute load max flag
 
-	if(!_absMotorFlag){
+#if (CVSLE_thermalMode == 1)
 
-		//Set triacDriver High
-		digitalWrite(_triacDriverPin, LOW);
+//get junction temperature
+float CVSLE::getJunctionTemperature(){
 
+	//Step model
+	_thermalStep();
 
-	}//EOP motor Max not reached
+	//Return
+	return _thermalAmbient+_thermalRise;
 
-	//Call user defined routine
-	isrOverflow();
+}//EOP getJunctionTemperature
 
-	//Reset prescaler and stop timer
-	*_prescaler_P=0;
 
+//get thermal derate
+byte CVSLE::getThermalDerate(){
 
-}//EOP overflowInterruptRoutine
+	//Return
+	return _thermalDerate;
+
+}//EOP getThermalDerate
+
+
+//set ambient temperature
+void CVSLE::setAmbientTemperature(float ambient){
+
+	_thermalAmbient=ambient;
+
+}//EOP setAmbientTemperature
+
+
+//Thermal model step
+void CVSLE::_thermalStep(){
+
+	//Variables
+	uint32_t period;
+	float loss;
+	float target;
+	float derate;
+	uint16_t floorTC;
+
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Take counted half cycles once enough are in
+	 * 2) Triac dissipation from measured current or conduction angle
+	 * 3) Junction rise as a first order RC, exact for constant loss
+	 * 4) Scale allowed firing range down between derate start and limit
+	 *
+	 */
+
+
+	//Step 1 => Counted half cycles
+	noInterrupts();
+
+	if(_thermalCycles<CVSLE_thermalStepCycles){
+
+		interrupts();
+
+		return;
+
+	}//EOP not enough yet
+
+#if (CVSLE_meteringMode == 1)
+	uint32_t sumI=_thermalSumI;
+	uint32_t sumI2=_thermalSumI2;
+	uint32_t samples=_thermalSamples;
+	_thermalSumI=0;
+	_thermalSumI2=0;
+	_thermalSamples=0;
+#else
+	uint32_t conduction=_thermalConduction;
+#endif
+	period=_thermalPeriod;
+	_thermalConduction=0;
+	_thermalPeriod=0;
+	_thermalCycles=0;
+
+	interrupts();
+
+	//Check period
+	if(period==0){
+
+		return;
+
+	}//EOP no valid crossings
+
+	//Step 2 => Dissipation
+#if (CVSLE_meteringMode == 1)
+
+	//Means of measured |I| and I squared over every half cycle of the step
+	float current=0;
+	float current2=0;
+
+	if(samples>0){
+
+		current=((float)sumI/samples)*CVSLE_currentScale;
+		current2=((float)sumI2/samples)*CVSLE_currentScale*CVSLE_currentScale;
+
+	}//EOP samples taken
+
+	loss=(CVSLE_thermalVT0*current)+(CVSLE_thermalRD*current2);
 
+#else
+
+	//Rated loss scaled by share of time conducting
+	loss=CVSLE_thermalLoss*((float)conduction/period);
+
+#endif
+
+	//Step 3 => Junction rise over ambient
+	target=loss*CVSLE_thermalRth;
+	_thermalRise=target+( (_thermalRise-target)*exp( -((float)period*CVSLE_ZDTickUS*1e-6)/CVSLE_thermalTau ) );
+
+	//Step 4 => Derating
+	derate=(CVSLE_thermalLimit-(_thermalAmbient+_thermalRise))/(CVSLE_thermalLimit-CVSLE_thermalDerateStart);
+
+	if(derate>=1){
+
+		derate=1;
+		floorTC=0;
+
+	}//EOP below derate start
+	else{
+
+		if(derate<0){
+
+			derate=0;
+
+		}//EOP at limit
+
+		floorTC=CVSLE_PTMAXTC-(uint16_t)(derate*(CVSLE_PTMAXTC-CVSLE_PTMINTC));
+
+	}//EOP derating
+
+	_thermalDerate=(byte)(derate*100);
+
+	noInterrupts();
+	_thermalFloor=floorTC;
+	interrupts();
+
+}//EOP _thermalStep
+
+#endif
+
+
+
+#if (CVSLE_loadIDMode == 1)
+
+//Identify load
+byte CVSLE::identifyLoad(byte halfCycles){
+
+	//Variables
+	byte result=CVSLE_loadUnknown;
+	uint16_t lag=0;
+	uint32_t peak=0;
+	uint32_t mean=0;
+	uint32_t early=0;
+	uint32_t late=0;
+	bool conducted=false;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Fire test A late in the half cycle, long gate, phase angle
+	 * 2) Take current lag, crest from test A
+	 * 3) Fire test B at about half conduction
+	 * 4) Take current lag, peak drift from test B
+	 * 5) Classify the load
+	 * 6) Select firing strategy
+	 *
+	 */
+
+
+	//Check motorStatus
+	if(motorStatus){
+
+		return result;
+
+	}//EOP motor Status is ON
+
+	//At least one half cycle in each quarter
+	if(halfCycles<4){
+
+		halfCycles=4;
+
+	}//EOP too short
+
+	//Step 1 => Test A, latch any load with a long gate
+	setLoadType(CVSLE_loadUnknown);
+	_gateWidth=CVSLE_loadIDGateTC;
+
+	if(!_loadIDTest(CVSLE_loadIDTestTCA, halfCycles)){
+
+		setLoadType(CVSLE_loadUnknown);
+
+		return result;
+
+	}//EOP no mains
+
+	//Step 2 => Lag and crest
+	lag=_idLagSum/(halfCycles-1);
+	peak=_idPeakSum/halfCycles;
+
+	if(_idCount>0){
+
+		mean=_idSum/_idCount;
+		conducted=true;
+
+	}//EOP current seen
+
+	//Step 3 => Test B
+	if(!_loadIDTest(CVSLE_loadIDTestTCB, halfCycles)){
+
+		setLoadType(CVSLE_loadUnknown);
+
+		return result;
+
+	}//EOP no mains
+
+	//Step 4 => Lag and drift
+	if( (_idLagSum/(halfCycles-1))>lag ){
+
+		lag=_idLagSum/(halfCycles-1);
+
+	}//EOP larger lag
+
+	early=_idEarly;
+	late=_idLate;
+	conducted=conducted || (_idCount>0);
+
+	//Step 5 => Classify
+	if(!conducted){
+
+		result=CVSLE_loadUnknown;
+
+	}//EOP no current, open load or no sensor
+	else if( (mean>0) && (peak>(mean*CVSLE_loadIDCrest)) ){
+
+		result=CVSLE_loadCapacitive;
+
+	}//EOP current spike at firing
+	else if(lag>CVSLE_loadIDLagTC){
+
+		if( (early>late) && (((early-late)*100)>(early*CVSLE_loadIDDrift)) ){
+
+			result=CVSLE_loadMotor;
+
+		}//EOP current falls as rotor speeds up
+		else{
+
+			result=CVSLE_loadInductive;
+
+		}//EOP steady current
+
+	}//EOP current past zero-cross
+	else{
+
+		result=CVSLE_loadResistive;
+
+	}//EOP current in phase
+
+	//Step 6 => Strategy
+	setLoadType(result, lag);
+
+	//Return statement
+	return result;
+
+}//EOP identifyLoad
+
+
+//get load type
+byte CVSLE::getLoadType(){
+
+	//Return
+	return _loadType;
+
+}//EOP getLoadType
+
+
+//set load type
+void CVSLE::setLoadType(byte loadType, uint16_t lagTC){
+
+	//Variables
+	bool integralCycle=false;
+	byte gateWidth=CVSLE_triacDriverDelay;
+	uint16_t minTC=CVSLE_PTMINTC;
+
+
+	//Check motorStatus
+	if(motorStatus){
+
+		return;
+
+	}//EOP motor Status is ON
+
+	switch(loadType){
+
+		case CVSLE_loadResistive:
+		case CVSLE_loadCapacitive:
+
+			//Whole cycles at zero voltage, no switching spikes or EMI
+			integralCycle=true;
+
+			break;
+
+		case CVSLE_loadInductive:
+		case CVSLE_loadMotor:
+
+			//Fire only once the current of the previous half cycle has died out
+			gateWidth=CVSLE_loadIDGateTC;
+
+			if((lagTC+CVSLE_loadIDMarginTC)>minTC){
+
+				minTC=lagTC+CVSLE_loadIDMarginTC;
+
+			}//EOP lag past load min
+
+			if(minTC>CVSLE_PTMAXTC){
+
+				minTC=CVSLE_PTMAXTC;
+
+			}//EOP clamp
+
+			break;
+
+		default:
+
+			loadType=CVSLE_loadUnknown;
+			lagTC=0;
+
+			break;
+
+	}//EOP switch
+
+	noInterrupts();
+	_loadType=loadType;
+	_loadLag=lagTC;
+	_integralCycle=integralCycle;
+	_gateWidth=gateWidth;
+	_loadMinTC=minTC;
+	_cycleHalf=0;
+	_cycleAcc=0;
+	interrupts();
+
+}//EOP setLoadType
+
+
+//get load lag
+uint16_t CVSLE::getLoadLag(){
+
+	//Return
+	return _loadLag;
+
+}//EOP getLoadLag
+
+
+//get integral cycle
+bool CVSLE::getIntegralCycle(){
+
+	//Return
+	return _integralCycle;
+
+}//EOP getIntegralCycle
+
+
+//Load test sample
+void CVSLE::_loadIDSample(uint16_t current){
+
+	//Variables
+	uint16_t elapsed;
+
+
+	//Check test running and current flowing
+	if( (!_idRun) || (current<=CVSLE_loadIDThreshold) ){
+
+		return;
+
+	}//EOP nothing to take
+
+	elapsed=_ZDElapsed();
+
+	if(elapsed<_setpoint[_setpointIndex]){
+
+		//Before firing, current carried over from the previous half cycle
+		if(elapsed>_idLagRun){
+
+			_idLagRun=elapsed;
+
+		}//EOP later extinction
+
+	}//EOP before firing
+	else{
+
+		_idSum+=current;
+		_idCount++;
+
+		if(current>_idPeakRun){
+
+			_idPeakRun=current;
+
+		}//EOP new peak
+
+	}//EOP conducting
+
+
+}//EOP _loadIDSample
+
+
+//Load test half cycle
+void CVSLE::_loadIDHalfCycle(){
+
+	//Variables
+	byte quarter=_idCycles/4;
+
+
+	//Check test running
+	if(!_idRun){
+
+		return;
+
+	}//EOP no test
+
+	if(_idSkip){
+
+		//Half cycle the test started in was not fired
+		_idSkip=false;
+
+	}//EOP first crossing
+	else if(_idHalfCycles<_idCycles){
+
+		//Lag seen now belongs to the half cycle before, none before the first
+		if(_idHalfCycles>0){
+
+			_idLagSum+=_idLagRun;
+
+		}//EOP previous half cycle fired
+
+		_idPeakSum+=_idPeakRun;
+
+		if(_idHalfCycles<quarter){
+
+			_idEarly+=_idPeakRun;
+
+		}//EOP first quarter
+		else if(_idHalfCycles>=(_idCycles-quarter)){
+
+			_idLate+=_idPeakRun;
+
+		}//EOP last quarter
+
+		_idHalfCycles++;
+
+	}//EOP test half cycle
+
+	_idLagRun=0;
+	_idPeakRun=0;
+
+}//EOP _loadIDHalfCycle
+
+
+//Load test
+bool CVSLE::_loadIDTest(uint16_t delayTC, byte halfCycles){
+
+	//Variables
+	unsigned long testStart=0;
+	bool result=false;
+
+
+	//Reset accumulators
+	noInterrupts();
+	_idCycles=halfCycles;
+	_idHalfCycles=0;
+	_idSkip=true;
+	_idLagRun=0;
+	_idPeakRun=0;
+	_idSum=0;
+	_idCount=0;
+	_idLagSum=0;
+	_idPeakSum=0;
+	_idEarly=0;
+	_idLate=0;
+	interrupts();
+
+	//Fire at the test delay from the next zero-cross on
+	_firingDelay=delayTC;
+	_absMotorFlag=false;
+	_publishFiringDelay();
+	_relayWrite(HIGH);
+
+	noInterrupts();
+	_idRun=true;
+	motorStatus=true;
+	interrupts();
+
+	//Wait for half cycles, twice the nominal time at most
+	testStart=_timeNow();
+
+	while( (_idHalfCycles<halfCycles) && ((_timeNow()-testStart)<cvsleDurationCast<CVSLETimeUnit>(CVSLEHalfCycles(2UL*(halfCycles+1))).count()) ){
+
+	}//EOP wait
+
+	result=(_idHalfCycles>=halfCycles);
+
+	//Stop firing, motorStatus first so a test is not recorded as a stop
+	noInterrupts();
+	_idRun=false;
+	motorStatus=false;
+	interrupts();
+
+	stopLoad();
+
+	//Return statement
+	return result;
+
+}//EOP _loadIDTest
+
+#endif
+
+
+#if (CVSLE_timeBaseMode == 1)
+
+//get half cycle count
+uint32_t CVSLE::getHalfCycleCount(){
+
+	//Variables
+	uint32_t result;
+	uint32_t residual;
+	uint16_t elapsed;
+	bool fallback;
+	uint8_t oldSREG=SREG; //_timeNow calls this from the ZD ISR through scheduled actions
+
+	noInterrupts();
+	result=_halfCycles;
+	residual=_timeResidual;
+	fallback=_timeFallback;
+	elapsed=*_timerCounter_ZD;
+
+	//Wrap not yet taken by the overflow ISR
+	if( (*_interruptflag_ZD & (1 << TOV1)) && (elapsed<0x8000) ){
+
+		residual+=0x10000UL;
+		fallback=true;
+
+	}//EOP overflow pending
+
+	SREG=oldSREG;
+
+	//Mains late or absent, crystal time since the last crossing or wrap
+	if( fallback || (elapsed>CVSLE_ZDMTC) ){
+
+		residual+=elapsed;
+
+	}//EOP not locked
+
+	result+=residual/CVSLE_timeNominalTC;
+
+	//Return
+	return result;
+
+}//EOP getHalfCycleCount
+
+
+//get time in milliSecs
+unsigned long CVSLE::getTimeMillis(){
+
+	//Return
+	return cvsleDurationCast<CVSLEMillis>(CVSLEHalfCycles(getHalfCycleCount())).count();
+
+}//EOP getTimeMillis
+
+
+//get time base locked
+bool CVSLE::getTimeBaseLocked(){
+
+	//Variables
+	bool result;
+
+	noInterrupts();
+	result=_timeLocked && (*_timerCounter_ZD<=CVSLE_ZDMTC);
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getTimeBaseLocked
+
+
+//Time base update
+void CVSLE::_timeBaseUpdate(uint16_t counter){
+
+	if( _timeFallback || (counter>CVSLE_ZDMTC) || (counter<CVSLE_timeGlitchTC) ){
+
+		//Crystal time up to this crossing, rounded to whole half cycles on return of mains
+		_timeResidual+=counter;
+
+		if(_timeFallback || (counter>CVSLE_ZDMTC)){
+
+			_timeResidual+=CVSLE_timeNominalTC/2;
+			_halfCycles+=_timeResidual/CVSLE_timeNominalTC;
+			_timeResidual=0;
+
+		}//EOP mains back
+		else{
+
+			_halfCycles+=_timeResidual/CVSLE_timeNominalTC;
+			_timeResidual=_timeResidual%CVSLE_timeNominalTC;
+
+		}//EOP glitch
+
+		_timeFallback=false;
+		_timeLocked=false;
+
+	}//EOP crystal
+	else{
+
+		//Mains half cycle
+		_halfCycles++;
+		_timeLocked=true;
+
+	}//EOP locked
+
+}//EOP _timeBaseUpdate
+
+#endif
+
+
+#if (CVSLE_bypassMode == 1)
+
+//get bypass state
+byte CVSLE::getBypassState(){
+
+	//Return
+	return _bypassState;
+
+}//EOP getBypassState
+
+
+//Bypass request
+void CVSLE::_bypassRequest(){
+
+	//Variables, a scheduled start calls this from the ZD ISR
+	uint8_t oldSREG=SREG;
+
+	noInterrupts();
+
+	//Start while a stop hands over, keep the load
+	_bypassStop=false;
+
+	if(_absMotorFlag){
+
+		//Close across the triac while it conducts fully
+		if( (_bypassState==CVSLE_bypassOpen) || (_bypassState==CVSLE_bypassOpening) ){
+
+			_bypassState=CVSLE_bypassClosing;
+			_bypassCount=0;
+
+		}//EOP not closed
+
+	}//EOP full load
+	else{
+
+		//Hand the load back to the triac before phase angle firing resumes
+		if( (_bypassState==CVSLE_bypassClosed) || (_bypassState==CVSLE_bypassClosing) ){
+
+			_bypassState=CVSLE_bypassOpening;
+			_bypassCount=0;
+
+		}//EOP not open
+
+	}//EOP below full load
+
+	SREG=oldSREG;
+
+}//EOP _bypassRequest
+
+
+//Bypass at zero-cross
+void CVSLE::_bypassZD(){
+
+	switch(_bypassState){
+
+		case CVSLE_bypassClosing:
+
+			//Contacts close across a conducting triac, no arc
+			if(_bypassCount==0){
+
+				digitalWrite(CVSLE_bypassPin,HIGH);
+
+			}//EOP first crossing
+
+			_bypassCount++;
+
+			if(_bypassCount>CVSLE_bypassOperateCycles){
+
+				//Contacts made, suspend firing
+				_bypassState=CVSLE_bypassClosed;
+				_gateWrite(LOW);
+
+			}//EOP operate time over
+
+			break;
+
+		case CVSLE_bypassOpening:
+
+			//Triac takes the current as the contacts part
+			if(_bypassCount==0){
+
+				_gateWrite(HIGH);
+				digitalWrite(CVSLE_bypassPin,LOW);
+
+			}//EOP first crossing
+
+			_bypassCount++;
+
+			if(_bypassCount>CVSLE_bypassReleaseCycles){
+
+				//Contacts open, firing resumes at this crossing
+				_bypassState=CVSLE_bypassOpen;
+				_gateWrite(LOW);
+
+				//Stop held back for the hand over, triac current ends at the next current zero
+				if(_bypassStop){
+
+					_bypassStop=false;
+					_relayWrite(LOW);
+
+				}//EOP stop pending
+
+			}//EOP release time over
+
+			break;
+
+		default:
+
+			break;
+
+	}//EOP switch
+
+}//EOP _bypassZD
+
+
+//Gate write
+void CVSLE::_gateWrite(byte level){
+
+	digitalWrite(_triacDriverPin, level);
+
+#if (CVSLE_threePhaseMode == 1)
+	digitalWrite(_triacDriverPinB, level);
+	digitalWrite(_triacDriverPinC, level);
+#endif
+
+}//EOP _gateWrite
+
+#endif
+
+
+#if (CVSLE_relaySyncMode == 1)
+
+//get relay operate delay
+uint16_t CVSLE::getRelayOperateDelay(){
+
+	//Variables
+	uint16_t result;
+
+	noInterrupts();
+	result=_relayDelay[1];
+	interrupts();
+
+	//Return
+	return CVSLEMicros(CVSLETicks(result)).count();
+
+}//EOP getRelayOperateDelay
+
+
+//get relay release delay
+uint16_t CVSLE::getRelayReleaseDelay(){
+
+	//Variables
+	uint16_t result;
+
+	noInterrupts();
+	result=_relayDelay[0];
+	interrupts();
+
+	//Return
+	return CVSLEMicros(CVSLETicks(result)).count();
+
+}//EOP getRelayReleaseDelay
+
+
+//set relay delay
+void CVSLE::setRelayDelay(uint16_t operateUS, uint16_t releaseUS){
+
+	noInterrupts();
+	_relayRated[0]=cvsleDurationCast<CVSLETicks>(CVSLEMicros(releaseUS)).count();
+	_relayRated[1]=cvsleDurationCast<CVSLETicks>(CVSLEMicros(operateUS)).count();
+	_relayDelay[0]=_relayRated[0];
+	_relayDelay[1]=_relayRated[1];
+	_relayFault=false;
+	interrupts();
+
+}//EOP setRelayDelay
+
+
+//get relay degraded
+bool CVSLE::getRelayDegraded(){
+
+	//Variables
+	bool result=false;
+
+	noInterrupts();
+	result=_relayFault;
+
+	for(byte i=0;i<2;i++){
+
+		if( ((uint32_t)_relayDelay[i]*100) > ((uint32_t)_relayRated[i]*(100+CVSLE_relayDrift)) ){
+
+			result=true;
+
+		}//EOP drifted
+
+	}//EOP directions
+
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getRelayDegraded
+
+
+//ZD timer compare routine
+void CVSLE::ZDCompareRoutine()
+{
+
+	//Check command armed
+	if(!_relayArmed){
+
+		return;
+
+	}//EOP nothing due
+
+	digitalWrite(_loadRelayPin,_relayTarget);
+	_relayLevel=_relayTarget;
+	_relayArmed=false;
+	_relayPending=false;
+
+	//Time the contacts from here
+	if(CVSLE_relaySensePin!=255){
+
+		_relayStamp=*_timerCounter_ZD;
+		_relayPeriods=0;
+		_relayMeasuring=true;
+
+	}//EOP sense pin used
+
+}//EOP ZDCompareRoutine
+
+
+//Relay at zero-cross
+void CVSLE::_relayZD(uint16_t counter){
+
+	//Variables
+	uint16_t period=counter;
+	uint16_t delayTC;
+	uint16_t offset;
+
+
+	//Step 1 => Contact timing across crossings
+	if(_relayMeasuring){
+
+		_relayPeriods+=counter;
+
+		if(_relayPeriods>CVSLE_relayTimeoutTC){
+
+			//Auxiliary contact did not follow the coil
+			_relayMeasuring=false;
+			_relayFault=true;
+
+		}//EOP timeout
+
+	}//EOP measuring
+
+	//Step 2 => Arm coil command so the contacts move at a later zero-cross
+	if(_relayPending){
+
+		if( (period>CVSLE_ZDMTC) || (period<(CVSLE_ZDMTC/4)) ){
+
+			period=CVSLE_ZDMTC/2;
+
+		}//EOP period out of range, nominal
+
+		delayTC=_relayDelay[(_relayTarget==HIGH) ? 1 : 0];
+		offset=period-(delayTC%period);
+
+		//Too close to the next crossing to be sure of the compare, command right away
+		if(offset>(period-CVSLE_relayGuardTC)){
+
+			offset=1;
+
+		}//EOP guard
+
+		*_outputCompare_ZD=offset;
+		*_interruptflag_ZD=(1 << OCF1A);
+		_relayArmed=true;
+
+	}//EOP command pending
+
+}//EOP _relayZD
+
+
+//Static wrapper for auxiliary contact
+void CVSLE::_relaySenseRoutine()
+{
+
+	//Variables
+	uint16_t delayTC;
+	byte index;
+
+
+	//Check contacts being timed and level matching the coil, bounce ignored
+	if( (!cvsLE._relayMeasuring) || ( (digitalRead(CVSLE_relaySensePin)==CVSLE_relaySenseClosed)!=(cvsLE._relayLevel==HIGH) ) ){
+
+		return;
+
+	}//EOP not timed
+
+	delayTC=cvsLE._relayPeriods+cvsLE._ZDElapsed()-cvsLE._relayStamp;
+	index=(cvsLE._relayLevel==HIGH) ? 1 : 0;
+
+	//Learn with a quarter weight so one slow operation does not shift it
+	cvsLE._relayDelay[index]=(uint16_t)((int32_t)cvsLE._relayDelay[index]+(((int32_t)delayTC-(int32_t)cvsLE._relayDelay[index])/4));
+	cvsLE._relayMeasuring=false;
+
+}//EOP _relaySenseRoutine
+
+#endif
+
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+//ZD timer overflow routine
+void CVSLE::ZDOverflowRoutine()
+{
+
+#if (CVSLE_powerQualityMode == 1)
+
+	//Count overflows, saturate on a dead supply
+	if(_pqOverflows<0xFFFF){
+
+		_pqOverflows++;
+
+	}//EOP not saturated
+
+#endif
+
+#if (CVSLE_timeBaseMode == 1)
+
+	//No zero-crossing for a full timer wrap, carry on with crystal time
+	_timeResidual+=0x10000UL;
+	_halfCycles+=_timeResidual/CVSLE_timeNominalTC;
+	_timeResidual=_timeResidual%CVSLE_timeNominalTC;
+	_timeFallback=true;
+	_timeLocked=false;
+
+#endif
+
+}//EOP ZDOverflowRoutine
+
+#endif
+
+
+#if (CVSLE_powerQualityMode == 1)
+
+
+//Power quality update
+void CVSLE::_pqUpdate(uint16_t counter)
+{
+
+	//Variables
+	uint32_t period=((uint32_t)_pqOverflows<<16)+counter;
+	_pqOverflows=0;
+
+	//First crossing after begin, no period yet
+	if(!_pqStarted){
+
+		_pqStarted=true;
+
+		return;
+
+	}//EOP first crossing
+
+	//Step 1 => Dropout, gap without crossings
+	if(period>CVSLE_pqDropoutTC){
+
+		_pqDropouts++;
+
+		if(period>_pqDropoutMax){
+
+			_pqDropoutMax=period;
+
+		}//EOP longest gap
+
+		return;
+
+	}//EOP dropout
+
+	//Step 2 => Glitch, extra edge inside a half cycle
+	if(period<CVSLE_pqGlitchTC){
+
+		_pqGlitches++;
+
+		return;
+
+	}//EOP glitch
+
+	//Step 3 => Histogram
+	int deviation=(int)period-CVSLE_pqNominalTC;
+	int bin=(deviation>>CVSLE_pqBinShift)+(CVSLE_pqBins/2);
+
+	if(bin<0){
+
+		bin=0;
+
+	}//EOP below range
+	else if(bin>=CVSLE_pqBins){
+
+		bin=CVSLE_pqBins-1;
+
+	}//EOP above range
+
+	if(_pqHistogram[bin]<0xFFFF){
+
+		_pqHistogram[bin]++;
+
+	}//EOP not saturated
+
+	//Step 4 => Window sums, deviation from nominal keeps squares small
+	_pqWinSum+=period;
+	_pqWinSq+=(uint32_t)((long)deviation*deviation);
+
+	if(period<_pqWinMin){
+
+		_pqWinMin=period;
+
+	}//EOP new min
+
+	if(period>_pqWinMax){
+
+		_pqWinMax=period;
+
+	}//EOP new max
+
+	_pqWinN++;
+
+	//Step 5 => Latch full window
+	if(_pqWinN>=CVSLE_pqWindow){
+
+		_pqNPrev=_pqN;
+		_pqSumPrev=_pqSum;
+
+		_pqN=_pqWinN;
+		_pqSum=_pqWinSum;
+		_pqSq=_pqWinSq;
+		_pqMin=_pqWinMin;
+		_pqMax=_pqWinMax;
+
+		_pqWinN=0;
+		_pqWinSum=0;
+		_pqWinSq=0;
+		_pqWinMin=0xFFFF;
+		_pqWinMax=0;
+
+	}//EOP window complete
+
+}//EOP _pqUpdate
+
+
+//get period min
+float CVSLE::getPeriodMin(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_pqMin;
+	interrupts();
+
+	//Return
+	return (float)result*CVSLE_ZDTickUS;
+
+}//EOP getPeriodMin
+
+
+//get period max
+float CVSLE::getPeriodMax(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_pqMax;
+	interrupts();
+
+	//Return
+	return (float)result*CVSLE_ZDTickUS;
+
+}//EOP getPeriodMax
+
+
+//get period mean
+float CVSLE::getPeriodMean(){
+
+	//Variables
+	byte n;
+	uint32_t sum;
+
+	noInterrupts();
+	n=_pqN;
+	sum=_pqSum;
+	interrupts();
+
+	//Check window
+	if(n==0){
+
+		return 0;
+
+	}//EOP no window yet
+
+	//Return
+	return ((float)sum/n)*CVSLE_ZDTickUS;
+
+}//EOP getPeriodMean
+
+
+//get period variance
+float CVSLE::getPeriodVariance(){
+
+	//Variables
+	byte n;
+	uint32_t sum;
+	uint32_t sq;
+
+	noInterrupts();
+	n=_pqN;
+	sum=_pqSum;
+	sq=_pqSq;
+	interrupts();
+
+	//Check window
+	if(n==0){
+
+		return 0;
+
+	}//EOP no window yet
+
+	//E[d^2]-E[d]^2 with d the deviation from nominal
+	float meanDev=((float)sum/n)-CVSLE_pqNominalTC;
+	float variance=((float)sq/n)-(meanDev*meanDev);
+
+	if(variance<0){
+
+		variance=0;
+
+	}//EOP rounding
+
+	//Return
+	return variance*CVSLE_ZDTickUS*CVSLE_ZDTickUS;
+
+}//EOP getPeriodVariance
+
+
+//get RoCoF
+float CVSLE::getRoCoF(){
+
+	//Variables
+	byte n;
+	uint32_t sum;
+	byte nPrev;
+	uint32_t sumPrev;
+
+	noInterrupts();
+	n=_pqN;
+	sum=_pqSum;
+	nPrev=_pqNPrev;
+	sumPrev=_pqSumPrev;
+	interrupts();
+
+	//Check windows
+	if( (n==0) || (nPrev==0) ){
+
+		return 0;
+
+	}//EOP less than two windows
+
+	//Frequency of each window, f = n / (2 * sum * tick)
+	float frequency=(n*1000000.0)/(2.0*sum*CVSLE_ZDTickUS);
+	float frequencyPrev=(nPrev*1000000.0)/(2.0*sumPrev*CVSLE_ZDTickUS);
+
+	//Windows are back to back, one window apart in time
+	float windowSecs=(sum*(float)CVSLE_ZDTickUS)/1000000.0;
+
+	//Return
+	return (frequency-frequencyPrev)/windowSecs;
+
+}//EOP getRoCoF
+
+
+//get period histogram
+uint16_t CVSLE::getPeriodHistogram(byte bin){
+
+	//Variables
+	uint16_t result=0;
+
+	//Check bin
+	if(bin<CVSLE_pqBins){
+
+		noInterrupts();
+		result=_pqHistogram[bin];
+		interrupts();
+
+	}//EOP valid bin
+
+	//Return
+	return result;
+
+}//EOP getPeriodHistogram
+
+
+//get dropout count
+uint16_t CVSLE::getDropoutCount(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_pqDropouts;
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getDropoutCount
+
+
+//get glitch count
+uint16_t CVSLE::getGlitchCount(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_pqGlitches;
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getGlitchCount
+
+
+//get longest dropout
+unsigned long CVSLE::getLongestDropout(){
+
+	//Variables
+	uint32_t result=0;
+
+	noInterrupts();
+	result=_pqDropoutMax;
+	interrupts();
+
+	//Return, split to keep ZD counts x tick inside 32 bits
+	return ( (result/1000)*CVSLE_ZDTickUS )+( ((result%1000)*CVSLE_ZDTickUS)/1000 );
+
+}//EOP getLongestDropout
+
+
+//reset power quality
+void CVSLE::resetPowerQuality(){
+
+	noInterrupts();
+
+	for(byte i=0;i<CVSLE_pqBins;i++){
+
+		_pqHistogram[i]=0;
+
+	}//EOP bins
+
+	_pqDropouts=0;
+	_pqGlitches=0;
+	_pqDropoutMax=0;
+
+	interrupts();
+
+}//EOP resetPowerQuality
+
+#endif
+
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+//Calibrate zero detect offset
+byte CVSLE::calibrateZeroDetect(byte halfCycles){
+
+	//Variables
+	byte result=0;
+	byte i=0;
+	unsigned long calStart=0;
+	int offset[2]={0, 0};
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Reset accumulators
+	 * 2) Attach zero detect on CHANGE to see both edges
+	 * 3) Wait for the given half cycles
+	 * 4) Restore zero detect interrupt
+	 * 5) Derive offsets from the pulse centre
+	 *
+	 */
+
+
+	//Check motorStatus
+	if(motorStatus){
+
+		return result;
+
+	}//EOP motor Status is ON
+
+	//Step 1 => Reset accumulators
+	noInterrupts();
+
+	for(i=0;i<2;i++){
+
+		_calHigh[i]=0;
+		_calPeriod[i]=0;
+		_calCount[i]=0;
+		_calPeriodCount[i]=0;
+
+	}//EOP reset
+
+	interrupts();
+
+	//Step 2 => Attach on CHANGE
+	detachInterrupt(digitalPinToInterrupt(_interruptPin));
+	attachInterrupt(digitalPinToInterrupt(_interruptPin), _ZDCalRoutine, CHANGE);
+
+	//Step 3 => Wait for half cycles, twice the nominal time at most
+	calStart=_timeNow();
+
+	while( ((_calCount[0]+_calCount[1])<halfCycles) && ((_timeNow()-calStart)<cvsleDurationCast<CVSLETimeUnit>(CVSLEHalfCycles(2UL*halfCycles)).count()) ){
+
+	}//EOP wait
+
+	//Step 4 => Restore zero detect interrupt
+	detachInterrupt(digitalPinToInterrupt(_interruptPin));
+	attachInterrupt(digitalPinToInterrupt(_interruptPin), _ZDRoutine, CVSLE_ZDMode);
+
+	//Step 5 => Derive offsets
+	if( (_calCount[0]>0) && (_calCount[1]>0) && (_calPeriodCount[0]>0) && (_calPeriodCount[1]>0) ){
+
+		for(i=0;i<2;i++){
+
+			//Mean pulse and half cycle length of half cycle i
+			long high=_calHigh[i]/_calCount[i];
+			long period=_calPeriod[i]/_calPeriodCount[i];
+
+			if(high<(period-high)){
+
+				//Edge starts a short pulse, true zero is at its centre
+				offset[i]+=high/2;
+
+			}//EOP pulse follows edge
+			else{
+
+				//Edge ends a short pulse, true zero of next half cycle is before it
+				offset[i^1]-=(period-high)/2;
+
+			}//EOP pulse precedes edge
+
+		}//EOP half cycles
+
+		//Check range
+		if( (abs(offset[0])<=CVSLE_ZDOffsetMax) && (abs(offset[1])<=CVSLE_ZDOffsetMax) ){
+
+			setZDOffset(offset[0], offset[1]);
+
+			result=1;
+
+		}//EOP offsets OK
+
+	}//EOP both half cycles measured
+
+	//Return statement
+	return result;
+
+}//EOP calibrateZeroDetect
+
+
+//get zero detect offset
+int CVSLE::getZDOffset(byte halfCycle){
+
+	//Variables
+	int result=0;
+
+	result=_ZDOffset[halfCycle&1];
+
+	//Return
+	return result;
+
+}//EOP getZDOffset
+
+
+//set zero detect offset
+void CVSLE::setZDOffset(int offsetEven, int offsetOdd){
+
+	//Check motorStatus
+	if(!motorStatus){
+
+		noInterrupts();
+		_ZDOffset[0]=constrain(offsetEven, -CVSLE_ZDOffsetMax, CVSLE_ZDOffsetMax);
+		_ZDOffset[1]=constrain(offsetOdd, -CVSLE_ZDOffsetMax, CVSLE_ZDOffsetMax);
+		interrupts();
+
+	}//EOP motor Status is OFF
+
+
+}//EOP setZDOffset
+
+#endif
+
+
+#if (CVSLE_pulseTrainMode == 1)
+
+//set gate pulse train
+void CVSLE::setGatePulseTrain(byte pulseCount, byte pulseWidth, byte pulseSpacing){
+
+	//Check motorStatus
+	if(!motorStatus){
+
+		//Check pulseCount
+		if(pulseCount>CVSLE_pulseCountMax){
+
+			_pulseCount=CVSLE_pulseCountMax;
+
+		}//EOP beyond max limit
+		else if(pulseCount<1){
+
+			_pulseCount=1;
+
+		}//EOP below min limit
+		else{
+
+			_pulseCount=pulseCount;
+
+		}//EOP given input ok
+
+		//Pulse width and spacing must be non zero
+		_pulseWidth=(pulseWidth>0)?pulseWidth:CVSLE_pulseWidth;
+		_pulseSpacing=(pulseSpacing>0)?pulseSpacing:CVSLE_pulseSpacing;
+
+		//Spacing is counted back from the compare value
+		if(_pulseSpacing>CVSLE_PTMINTC){
+
+			_pulseSpacing=CVSLE_PTMINTC;
+
+		}//EOP beyond max spacing
+
+	}//EOP motor Status is OFF
+
+
+}//EOP setGatePulseTrain
+
+#endif
+
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+//get current limit
+uint16_t CVSLE::getCurrentLimit(){
+
+	//Variables
+	uint16_t result=0;
+
+	result=_currentLimit;
+
+	//Return
+	return result;
+
+}//EOP getCurrentLimit
+
+
+//set current limit
+void CVSLE::setCurrentLimit(uint16_t currentLimit){
+
+	//Check motorStatus
+	if(!motorStatus){
+
+		_currentLimit=currentLimit;
+
+	}//EOP motor Status is OFF
+
+
+}//EOP setCurrentLimit
+
+
+//get load current peak
+uint16_t CVSLE::getLoadCurrentPeak(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_currentPeak;
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getLoadCurrentPeak
+
+
+//Adaptive soft start step
+void CVSLE::_adaptiveStep(long TCMin, long TCMax){
+
+	//Variables
+	long delayTC=_firingDelay;
+
+	//Check current peak against limit
+	if(_currentPeak>_currentLimit){
+
+		//Hold back
+		delayTC=delayTC+CVSLE_adaptiveStepTC;
+
+		if(delayTC>TCMax){
+
+			delayTC=TCMax;
+
+		}//EOP beyond max delay
+
+	}//EOP limit exceeded
+	else{
+
+		//Advance
+		delayTC=delayTC-CVSLE_adaptiveStepTC;
+
+		if(delayTC<=TCMin){
+
+			delayTC=TCMin;
+
+			//Ramp complete
+			_softStartIntervalCount=CVSLE_PTTCDIV;
+
+		}//EOP target reached
+
+	}//EOP limit ok
+
+	_firingDelay=delayTC;
+
+
+}//EOP _adaptiveStep
+
+#endif
+
+
+#if (CVSLE_threePhaseMode == 1)
+
+//Begin function for three phase operation
+byte CVSLE::beginThreePhase(byte interruptPinA, byte interruptPinB, byte interruptPinC, byte triacDriverPinA, byte triacDriverPinB, byte triacDriverPinC, byte loadRelayPin, bool inputPullupINT){
+
+	//Variables
+	byte result=0;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Init phase A through the single phase begin
+	 * 2) Init phase B and C pins
+	 * 3) AttachInterrupt for phase B and C zero detect
+	 *
+	 */
+
+
+	//Step 1 => Phase A
+	result=begin(interruptPinA, triacDriverPinA, loadRelayPin, inputPullupINT);
+
+	//Check result
+	if(result!=0){
+
+		//Step 2 => Phase B and C pins
+		_interruptPinB=interruptPinB;
+		_interruptPinC=interruptPinC;
+		_triacDriverPinB=triacDriverPinB;
+		_triacDriverPinC=triacDriverPinC;
+
+		//Check pullup for interrupt
+		if(_inputPullupINT){
+
+			pinMode(_interruptPinB, INPUT_PULLUP);
+			pinMode(_interruptPinC, INPUT_PULLUP);
+
+		}//EOP check flag
+
+		pinMode(_triacDriverPinB,OUTPUT);
+		pinMode(_triacDriverPinC,OUTPUT);
+
+
+		//Step 3 => Attach zero detect interrupts
+		attachInterrupt(digitalPinToInterrupt(_interruptPinB), _ZDRoutineB, CVSLE_ZDMode);
+		attachInterrupt(digitalPinToInterrupt(_interruptPinC), _ZDRoutineC, CVSLE_ZDMode);
+
+	}//EOP result OK
+
+	//Return statement
+	return result;
+
+}//EOP beginThreePhase
+
+
+//getPhaseStatus
+byte CVSLE::getPhaseStatus(){
+
+	//Variables
+	byte result=0;
+
+	result=_phaseStatus;
+
+	//Return
+	return result;
+
+}//EOP getPhaseStatus
+
+#endif
+
+
+
+
+//****************************
+//  Interrupt Function
+//****************************
+
+#if (CVSLE_eventSystemMode == 0)
+
+//process timer init
+#if (CVSLE_ProcessTimer == 1)
+
+//Compare ISR
+ISR(TIMER1_COMPA_vect){
+
+	//Compare routine
+	cvsLE.compareInterruptRoutine();
+
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER1_OVF_vect){
+
+	//Overflow routine
+	cvsLE.overflowInterruptRoutine();
+
+}//EOP overflow ISR
+
+#if (CVSLE_singleTimerMode == 1)
+
+//CompareB ISR
+ISR(TIMER1_COMPB_vect){
+
+	//CompareB routine
+	cvsLE.compareBInterruptRoutine();
+
+}//EOP compareB ISR
+
+#endif
+
+#elif (CVSLE_ProcessTimer == 3)
+
+//Compare ISR
+ISR(TIMER3_COMPA_vect){
+
+	//Compare routine
+	cvsLE.compareInterruptRoutine();
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER3_OVF_vect){
+
+	//Overflow routine
+	cvsLE.overflowInterruptRoutine();
+
+}//EOP overflow ISR
+
+
+
+#elif (CVSLE_ProcessTimer == 4)
+
+//Compare ISR
+ISR(TIMER4_COMPA_vect){
+
+	//Compare routine
+	cvsLE.compareInterruptRoutine();
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER4_OVF_vect){
+
+	//Overflow routine
+	cvsLE.overflowInterruptRoutine();
+
+}//EOP overflow ISR
+
+
+
+#elif (CVSLE_ProcessTimer == 5)
+
+//Compare ISR
+ISR(TIMER5_COMPA_vect){
+
+	//Compare routine
+	cvsLE.compareInterruptRoutine();
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER5_OVF_vect){
+
+	//Overflow routine
+	cvsLE.overflowInterruptRoutine();
+
+}//EOP overflow ISR
+
+
+#endif
+
+
+//ZD timer init
+#if (CVSLE_singleTimerMode == 1)
+
+//ZD shares the process timer, no ISRs of its own
+
+
+#elif (CVSLE_ZDTimer == 1)
+
+//Compare ISR
+ISR(TIMER1_COMPA_vect){
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Relay coil command
+	cvsLE.ZDCompareRoutine();
+
+#endif
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER1_OVF_vect){
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	//Extend ZD timer past 16 bits
+	cvsLE.ZDOverflowRoutine();
+
+#endif
+
+}//EOP overflow ISR
+
+
+
+#elif (CVSLE_ZDTimer == 3)
+
+//Compare ISR
+ISR(TIMER3_COMPA_vect){
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Relay coil command
+	cvsLE.ZDCompareRoutine();
+
+#endif
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER3_OVF_vect){
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	//Extend ZD timer past 16 bits
+	cvsLE.ZDOverflowRoutine();
+
+#endif
+
+}//EOP overflow ISR
+
+
+
+#elif (CVSLE_ZDTimer == 4)
+
+//Compare ISR
+ISR(TIMER4_COMPA_vect){
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Relay coil command
+	cvsLE.ZDCompareRoutine();
+
+#endif
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER4_OVF_vect){
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	//Extend ZD timer past 16 bits
+	cvsLE.ZDOverflowRoutine();
+
+#endif
+
+}//EOP overflow ISR
+
+
+
+#elif (CVSLE_ZDTimer == 5)
+
+//Compare ISR
+ISR(TIMER5_COMPA_vect){
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Relay coil command
+	cvsLE.ZDCompareRoutine();
+
+#endif
+
+}//EOP compare ISR
+
+
+//Overflow ISR
+ISR(TIMER5_OVF_vect){
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	//Extend ZD timer past 16 bits
+	cvsLE.ZDOverflowRoutine();
+
+#endif
+
+}//EOP overflow ISR
+
+
+#endif
+
+#endif
+
+
+
+#if (CVSLE_adaptiveStartMode == 1) || (CVSLE_meteringMode == 1)
+
+//ADC ISR
+ISR(ADC_vect){
+
+	//ADC routine
+	cvsLE.adcInterruptRoutine();
+
+}//EOP ADC ISR
+
+#endif
+
+
+#if (CVSLE_hookMode == 0)
+
+//Set compare attach routine to default
+void (*CVSLE::isrCompare)()= CVSLE::isrDefaultUnused;
+
+//Set overflow attach routine to default
+void (*CVSLE::isrOverflow)()= CVSLE::isrDefaultUnused;
+
+//Default function
+void CVSLE::isrDefaultUnused()
+{
+}
+
+#endif
+
+
+//Compare hook
+inline void CVSLE::_compareHook()
+{
+
+#if (CVSLE_hookMode == 1)
+	CVSLE_compareHook();
+#else
+	isrCompare();
+#endif
+
+}//EOP _compareHook
+
+
+//Overflow hook
+inline void CVSLE::_overflowHook()
+{
+
+#if (CVSLE_hookMode == 1)
+	CVSLE_overflowHook();
+#else
+	isrOverflow();
+#endif
+
+}//EOP _overflowHook
+
+
+#if (CVSLE_eventSystemMode == 0)
+
+//Static wrapper for ZD
+void CVSLE::_ZDRoutine()
+{
+
+#if (CVSLE_recorderMode == 1)
+
+	//ISR run time for the recorder
+	uint16_t entry=micros();
+
+#endif
+
+#if (CVSLE_singleTimerMode == 1)
+
+	//Timestamp crossing on the free running timer
+	cvsLE._ZDStamp=*cvsLE._timerCounter_P;
+
+#endif
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	//Next half cycle
+	cvsLE._ZDParity^=1;
+
+#endif
+
+#if (CVSLE_timeBaseMode == 1)
+
+	//Advance time base on the raw period before the schedule reads it
+	cvsLE._timeBaseUpdate(*cvsLE._timerCounter_ZD);
+
+#endif
+
+#if (CVSLE_scheduleMode == 1)
+
+	//Due actions take effect in this half cycle
+	cvsLE._runSchedule();
+
+#endif
+
+#if (CVSLE_bypassMode == 1)
+
+	//Contactor hand over, no firing while the contactor carries the load
+	cvsLE._bypassZD();
+
+	//check motorStatus flag
+	if( cvsLE.motorStatus && (cvsLE._bypassState!=CVSLE_bypassClosed) && (cvsLE._bypassState!=CVSLE_bypassOpening) ){
+
+#else
+
+	//check motorStatus flag
+	if(cvsLE.motorStatus){
+
+#endif
+
+		//Process ISR
+		cvsLE.zeroDetectISR();
+
+	}//EOP Load in ON
+	else{
+
+#if (CVSLE_singleTimerMode == 1)
+
+		//Disarm gate compares, timer keeps running as time base
+		*cvsLE._interruptMask_P=0;
+
+#else
+
+		//Reset prescaler and stop timer
+		*cvsLE._prescaler_P=0;
+
+		//Reset counter value
+		*cvsLE._timerCounter_P=0;
+
+#endif
+
+	}//EOP load is OFF
+
+
+	//ZD ISR
+	cvsLE.ZDTimerCalC();
+
+#if (CVSLE_recorderMode == 1)
+
+	//Log half cycle just finished
+	cvsRecorder.push(cvsLE._ZDCounter, cvsLE._setpoint[cvsLE._setpointIndex], cvsLE.getStateBits(), cvsLE.getFaultBits(), (uint16_t)micros()-entry);
+
+#endif
+
+}
+
+//Zero detect interrupt routine
+void CVSLE::zeroDetectISR()
+{
+
+#if (CVSLE_singleTimerMode == 1)
+
+	//Variables
+	uint16_t delayTC=_setpoint[_setpointIndex];
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	//End any train left from previous half cycle
+	digitalWrite(_triacDriverPin, LOW);
+	_pulseIndex=0;
+
+	//At full load start the train right after the crossing
+	if(_absMotorFlag){
+
+		delayTC=CVSLE_pulseTrainFullTC;
+
+	}//EOP full load
+
+	_pulseTime=delayTC;
+
+#endif
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	//Count firing delays from true zero instead of the detected edge
+	delayTC=delayTC+_ZDOffset[_ZDParity];
+
+#endif
+
+	//Arm compare A relative to the captured crossing
+	*_outputCompare_P=_ZDStamp+delayTC;
+	*_interruptflag_P=(1 << OCF1A);
+	*_interruptMask_P|=(1 << OCIE1A);
+
+#else
+
+#if (CVSLE_threePhaseMode == 1)
+
+	//Build gate schedule for this half cycle
+	_scheduleThreePhase();
+
+	//Check schedule
+	if(_eventCount==0){
+
+		//Nothing to fire, keep timer stopped
+		*_prescaler_P=0;
+
+		return;
+
+	}//EOP empty schedule
+
+#endif
+
+#if (CVSLE_threePhaseMode == 0)
+
+	//Commit firing delay for this half cycle while timer is stopped
+	*_prescaler_P=0;
+	*_outputCompare_P=_setpoint[_setpointIndex];
+
+#endif
+
+#if (CVSLE_loadIDMode == 1)
+
+	//Integral cycle firing switches whole cycles at the crossing, timer stays stopped
+	if(_integralCycle){
+
+		//Decide once per full cycle so both half cycles conduct, no DC into the load
+		if(_cycleHalf==0){
+
+			uint16_t delayTC=_setpoint[_setpointIndex];
+			uint16_t on=(delayTC<CVSLE_PTMAXTC) ? CVSLE_PTMAXTC-delayTC : 0;
+
+			//Spread on cycles evenly, share follows the phase angle time share
+			_cycleAcc+=on;
+
+			if(_cycleAcc>=(CVSLE_PTMAXTC-CVSLE_PTMINTC)){
+
+				_cycleAcc-=(CVSLE_PTMAXTC-CVSLE_PTMINTC);
+				_cycleOn=true;
+
+			}//EOP on cycle
+			else{
+
+				_cycleOn=false;
+
+			}//EOP off cycle
+
+		}//EOP first half cycle
+
+		_cycleHalf^=1;
+
+		//Gate held through the half cycle
+		digitalWrite(_triacDriverPin, (_cycleOn || _absMotorFlag) ? HIGH : LOW);
+
+		return;
+
+	}//EOP integral cycle
+
+#endif
+
+#if (CVSLE_pulseTrainMode == 1) && (CVSLE_threePhaseMode == 0)
+
+	//End any train left from previous half cycle
+	digitalWrite(_triacDriverPin, LOW);
+	_pulseIndex=0;
+	_pulseTime=*_outputCompare_P;
+
+#endif
+
+	//Set prescaler and start timer
+	*_prescaler_P=0;
+	*_prescaler_P=(1 << CS12);
+
+	//Reset counter value
+	*_timerCounter_P=0;
+
+#if (CVSLE_pulseTrainMode == 1) && (CVSLE_threePhaseMode == 0)
+
+	//At full load start the train right after the crossing
+	if(_absMotorFlag){
+
+		*_timerCounter_P=*_outputCompare_P-CVSLE_pulseTrainFullTC;
+		_pulseTime=CVSLE_pulseTrainFullTC;
+
+	}//EOP full load
+
+#endif
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	//Count firing delays from true zero instead of the detected edge
+	int offset=_ZDOffset[_ZDParity];
+	uint16_t start=*_timerCounter_P;
+
+	//Counter wraps below zero, first overflow is not a gate pulse end
+	_preRoll=( (offset>0) && (start<(uint16_t)offset) );
+
+	*_timerCounter_P=start-offset;
+
+#endif
+
+#endif
+
+
+}//EOP zeroDetectISR
+
+
+
+//Routine for ZD Timer
+void CVSLE::ZDTimerCalC()
+{
+
+#if (CVSLE_singleTimerMode == 1)
+
+	//Period between captured crossings
+	_ZDCounter=_ZDStamp-_ZDStampPrev;
+	_ZDStampPrev=_ZDStamp;
+
+#else
+
+	//ZD Timer
+	_ZDCounter=*_timerCounter_ZD;
+
+#endif
+
+#if (CVSLE_powerQualityMode == 1)
+
+	//Supply statistics on the raw period
+	_pqUpdate(_ZDCounter);
+
+#endif
+
+#if (CVSLE_relaySyncMode == 1)
+
+	//Relay coil command and contact timing on the raw period
+	_relayZD(_ZDCounter);
+
+#endif
+
+	//Check zd-Counter
+	if(_ZDCounter>CVSLE_ZDMTC){
+
+		//Set ZDcounter to zero
+		_ZDCounter=0;
+
+	}//EOP greater than required count
+
+#if (CVSLE_thermalMode == 1)
+
+	//Conduction of the half cycle just finished, from firing to this crossing
+	_thermalPeriod+=_ZDCounter;
+
+#if (CVSLE_bypassMode == 1)
+
+	//Bypass contactor carries the load, triac idle
+	if( motorStatus && (_bypassState!=CVSLE_bypassClosed) ){
+
+#else
+
+	if(motorStatus){
+
+#endif
+
+		uint16_t delay=(_absMotorFlag) ? 0 : _setpoint[_setpointIndex];
+
+		if(_ZDCounter>delay){
+
+			_thermalConduction+=_ZDCounter-delay;
+
+#if (CVSLE_meteringMode == 1)
+
+			//Measured current of the half cycle, metering sums not latched yet
+			if(_thermalCycles<255){
+
+				_thermalSumI+=_thermalRunI;
+				_thermalSumI2+=_sumI2;
+
+			}//EOP sums in range
+
+#endif
+
+		}//EOP fired this half cycle
+
+	}//EOP load running
+
+#if (CVSLE_meteringMode == 1)
+
+	//Half cycles without triac current count as zero in the means
+	if(_thermalCycles<255){
+
+		_thermalSamples+=_samples;
+
+	}//EOP sums in range
+
+	_thermalRunI=0;
+
+#endif
+
+	if(_thermalCycles<255){
+
+		_thermalCycles++;
+
+	}//EOP saturate
+
+#endif
+
+#if (CVSLE_loadIDMode == 1)
+
+	//Close half cycle of a running load test
+	_loadIDHalfCycle();
+
+#endif
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	//Latch current peak of the half cycle just finished
+	_currentPeak=_currentPeakRun;
+	_currentPeakRun=0;
+	_currentSampleReady=true;
+
+	//Half cycles in a row above the limit
+	if(_currentPeak>_currentLimit){
+
+		if(_currentOver<0xFF){
+
+			_currentOver++;
+
+		}//EOP not saturated
+
+	}//EOP over limit
+	else{
+
+		_currentOver=0;
+
+	}//EOP under limit
+
+#if (CVSLE_meteringMode == 0)
+
+	//Start conversions, free running from here on
+	ADCSRA |= (1 << ADSC);
+
+#endif
+
+#endif
+
+#if (CVSLE_meteringMode == 1)
+
+	//Latch sums of the half cycle just finished
+	_meterV2=_sumV2;
+	_meterI2=_sumI2;
+	_meterVI=_sumVI;
+	_meterN=_samples;
+	_sumV2=0;
+	_sumI2=0;
+	_sumVI=0;
+	_samples=0;
+
+	//Energy of the half cycle, mean V.I counts times ZD ticks
+	if(_meterN>0){
+
+		_energyAcc+=(int64_t)(_meterVI/(int32_t)_meterN)*_ZDCounter;
+
+	}//EOP samples taken
+
+	//Start conversion chain on first zero-cross
+	if(!_meterRunning){
+
+		_meterRunning=true;
+		_meterVoltagePhase=true;
+		_meterSelect(CVSLE_voltageChannel);
+		ADCSRA |= (1 << ADSC);
+
+	}//EOP chain not running
+
+#endif
+
+#if (CVSLE_threePhaseMode == 1)
+
+	//Verify phase B and C crossings seen in this half cycle
+	_checkPhases();
+
+#endif
+
+#if (CVSLE_singleTimerMode == 0)
+
+	//Reset ZD Counter
+	*_timerCounter_ZD=0;
+
+#endif
+
+#if (CVSLE_telemetryMode == 1)
+
+	//Queue record of the half cycle just finished
+	cvsTelemetry.push(_ZDCounter, _setpoint[_setpointIndex], getStateBits(), getFaultBits());
+
+#endif
+
+
+}//EOP zeroDetectISR
+
+
+
+
+//compareInterruptRoutine
+void CVSLE::compareInterruptRoutine()
+{
+
+#if (CVSLE_threePhaseMode == 1)
+
+	//Variables
+	byte i=_eventIndex;
+
+	//Process every event that is already due
+	do{
+
+		digitalWrite(_eventPin[i], _eventLevel[i]);
+
+		i++;
+
+		//Check end of schedule
+		if(i>=_eventCount){
+
+			//Reset prescaler and stop timer
+			*_prescaler_P=0;
+
+			break;
+
+		}//EOP end of schedule
+
+		//Next event
+		*_outputCompare_P=_eventTime[i];
+
+	}while(*_timerCounter_P>=_eventTime[i]);
+
+	_eventIndex=i;
+
+
+	//Call user defined routine
+	_compareHook();
+
+#elif (CVSLE_singleTimerMode == 1)
+
+	//Set triacDriver High
+	digitalWrite(_triacDriverPin, HIGH);
+
+
+	//Call user defined routine
+	_compareHook();
+
+
+	//One shot, gate pulse ends on compare B
+	*_interruptMask_P&=~(1 << OCIE1A);
+#if (CVSLE_pulseTrainMode == 1)
+	*_outputCompareB_P=*_timerCounter_P+_pulseWidth;
+#else
+	*_outputCompareB_P=*_timerCounter_P+CVSLE_triacDriverDelay;
+#endif
+	*_interruptflag_P=(1 << OCF1B);
+	*_interruptMask_P|=(1 << OCIE1B);
+
+#else
+
+	//Set triacDriver High
+	digitalWrite(_triacDriverPin, HIGH);
+
+
+	//Call user defined routine
+	_compareHook();
+
+
+	//Set counter value close to overflow to switch off triacDriver pulse
+#if (CVSLE_pulseTrainMode == 1)
+	*_timerCounter_P=CVSLE_PTimerMax-_pulseWidth;
+#elif (CVSLE_loadIDMode == 1)
+	*_timerCounter_P=CVSLE_PTimerMax-_gateWidth;
+#else
+	*_timerCounter_P=CVSLE_PTimerMax-CVSLE_triacDriverDelay;
+#endif
+
+#endif
+
+
+}//EOP compareInterruptRoutine
+
+//overflowInterruptRoutine
+void CVSLE::overflowInterruptRoutine()
+{
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	//Counter passed true zero, keep running towards compare
+	if(_preRoll){
+
+		_preRoll=false;
+
+		return;
+
+	}//EOP pre roll
+
+#endif
+
+#if (CVSLE_pulseTrainMode == 1) && (CVSLE_threePhaseMode == 0)
+
+	//End of gate pulse
+	digitalWrite(_triacDriverPin, LOW);
+
+	//Next pulse of the train
+	_pulseIndex++;
+	_pulseTime=_pulseTime+_pulseWidth+_pulseSpacing;
+
+	//Call user defined routine
+	_overflowHook();
+
+	//Check train count and end of half cycle
+	if( (_pulseIndex<_pulseCount) && ((_pulseTime+_pulseWidth)<=CVSLE_pulseTrainEndTC) ){
+
+		//Re-trigger compare after spacing
+		*_timerCounter_P=*_outputCompare_P-_pulseSpacing;
+
+	}//EOP train continues
+	else{
+
+		//Reset prescaler and stop timer
+		*_prescaler_P=0;
+
+	}//EOP train done
+
+#else
+
+	//Check absolute load max flag
+
+	if(!_absMotorFlag){
+
+		//Set triacDriver High
+		digitalWrite(_triacDriverPin, LOW);
+
+
+	}//EOP motor Max not reached
+
+	//Call user defined routine
+	_overflowHook();
+
+	//Reset prescaler and stop timer
+	*_prescaler_P=0;
+
+#endif
+
+
+}//EOP overflowInterruptRoutine
+
+
+#if (CVSLE_singleTimerMode == 1)
+
+//compareBInterruptRoutine
+void CVSLE::compareBInterruptRoutine()
+{
+
+	//One shot
+	*_interruptMask_P&=~(1 << OCIE1B);
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	//End of gate pulse
+	digitalWrite(_triacDriverPin, LOW);
+
+	//Next pulse of the train
+	_pulseIndex++;
+	_pulseTime=_pulseTime+_pulseWidth+_pulseSpacing;
+
+	//Call user defined routine
+	_overflowHook();
+
+	//Check train count and end of half cycle
+	if( (_pulseIndex<_pulseCount) && ((_pulseTime+_pulseWidth)<=CVSLE_pulseTrainEndTC) ){
+
+		//Re-trigger compare A after spacing
+		*_outputCompare_P=*_timerCounter_P+_pulseSpacing;
+		*_interruptflag_P=(1 << OCF1A);
+		*_interruptMask_P|=(1 << OCIE1A);
+
+	}//EOP train continues
+
+#else
+
+	//Check absolute load max flag
+	if(!_absMotorFlag){
+
+		//Set triacDriver Low
+		digitalWrite(_triacDriverPin, LOW);
+
+	}//EOP motor Max not reached
+
+	//Call user defined routine
+	_overflowHook();
+
+#endif
+
+
+}//EOP compareBInterruptRoutine
+
+#endif
+
+
+//ZD counts since last zero detect
+uint16_t CVSLE::_ZDElapsed()
+{
+
+	//Variables
+	uint16_t result=0;
+
+#if (CVSLE_singleTimerMode == 1)
+	result=*_timerCounter_P-_ZDStamp;
+#else
+	result=*_timerCounter_ZD;
+#endif
+
+	//Return
+	return result;
+
+}//EOP _ZDElapsed
+
+#endif
+
+
+
+#if (CVSLE_threePhaseMode == 1)
+
+//Static wrapper for phase B ZD
+void CVSLE::_ZDRoutineB()
+{
+
+	cvsLE.zeroDetectPhaseISR(1);
+
+}
+
+
+//Static wrapper for phase C ZD
+void CVSLE::_ZDRoutineC()
+{
+
+	cvsLE.zeroDetectPhaseISR(2);
+
+}
+
+
+//Phase B/C zero detect routine
+void CVSLE::zeroDetectPhaseISR(byte phase)
+{
+
+	//Timestamp against phase A crossing
+	if(phase==1){
+
+		_ZDPhaseB=_ZDElapsed();
+
+	}//EOP phase B
+	else{
+
+		_ZDPhaseC=_ZDElapsed();
+
+	}//EOP phase C
+
+	//Mark phase as seen
+	_phaseSeen|=phase;
+
+
+}//EOP zeroDetectPhaseISR
+
+
+//Check phase sequence and spacing
+void CVSLE::_checkPhases()
+{
+
+	/*
+	 * Detectors fire on every crossing, so within one phase A half cycle
+	 * an ABC supply shows C at one third and B at two thirds of the period.
+	 */
+
+	//Variables
+	int third=_ZDCounter/3;
+	int diffB=abs((int)_ZDPhaseB-(2*third));
+	int diffC=abs((int)_ZDPhaseC-third);
+
+	//Check both phases seen
+	if( (_phaseSeen!=3) || (_ZDCounter==0) ){
+
+		_phaseStatus=CVSLE_phaseMissing;
+
+	}//EOP phase missing
+	else if( (diffB<CVSLE_phaseTolerance) && (diffC<CVSLE_phaseTolerance) ){
+
+		_phaseStatus=CVSLE_phaseOK;
+
+	}//EOP ABC sequence
+	else if( (abs((int)_ZDPhaseB-third)<CVSLE_phaseTolerance) && (abs((int)_ZDPhaseC-(2*third))<CVSLE_phaseTolerance) ){
+
+		_phaseStatus=CVSLE_phaseSequence;
+
+	}//EOP ACB sequence
+	else{
+
+		_phaseStatus=CVSLE_phaseSpacing;
+
+	}//EOP spacing error
+
+	//Reset for next half cycle
+	_phaseSeen=0;
+
+
+}//EOP _checkPhases
+
+
+//Build three phase gate schedule
+void CVSLE::_scheduleThreePhase()
+{
+
+	//Variables
+	uint16_t period=_ZDCounter;
+	uint16_t delayTC=_setpoint[_setpointIndex];
+	uint16_t offset[3]={0, _ZDPhaseB, _ZDPhaseC};
+	byte pins[3]={_triacDriverPin, _triacDriverPinB, _triacDriverPinC};
+	byte pulses=1;
+	byte width=CVSLE_triacDriverDelay;
+	byte step=0;
+	byte i=0;
+	byte k=0;
+
+	//Reset schedule
+	_eventCount=0;
+	_eventIndex=0;
+
+	//Check phase status
+	if(_phaseStatus!=CVSLE_phaseOK){
+
+		return;
+
+	}//EOP phase fault
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	//Pulse train per phase
+	pulses=_pulseCount;
+	width=_pulseWidth;
+	step=_pulseWidth+_pulseSpacing;
+
+	//At full load start the train right after each crossing
+	if(_absMotorFlag){
+
+		delayTC=CVSLE_pulseTrainFullTC;
+
+	}//EOP full load
+
+#else
+
+	//Check abs load max
+	if(_absMotorFlag){
+
+		return;
+
+	}//EOP gates held high
+
+#endif
+
+	//Pull down any pulse left over from previous half cycle
+	for(i=0;i<3;i++){
+
+		digitalWrite(pins[i], LOW);
+
+	}//EOP gates low
+
+	//Fire times relative to phase A crossing, wrapped into this half cycle
+	for(i=0;i<3;i++){
+
+		for(k=0;k<pulses;k++){
+
+			uint16_t time=delayTC+(k*step);
+
+			//Keep train inside its own half cycle
+			if( (k>0) && ((time+width)>CVSLE_pulseTrainEndTC) ){
+
+				break;
+
+			}//EOP train end
+
+			time=(offset[i]+time)%period;
+
+			_addEvent(time, pins[i], HIGH);
+			_addEvent(time+width, pins[i], LOW);
+
+		}//EOP pulses
+
+	}//EOP phases
+
+	//First event
+	*_outputCompare_P=_eventTime[0];
+
+
+}//EOP _scheduleThreePhase
+
+
+//Insert gate event
+void CVSLE::_addEvent(uint16_t time, byte pin, byte level)
+{
+
+	//Variables
+	byte j=_eventCount;
+
+	//Shift later events up
+	while( (j>0) && (_eventTime[j-1]>time) ){
+
+		_eventTime[j]=_eventTime[j-1];
+		_eventPin[j]=_eventPin[j-1];
+		_eventLevel[j]=_eventLevel[j-1];
+
+		j--;
+
+	}//EOP shift later events
+
+	_eventTime[j]=time;
+	_eventPin[j]=pin;
+	_eventLevel[j]=level;
+
+	_eventCount++;
+
+
+}//EOP _addEvent
+
+#endif
+
+
+#if (CVSLE_meteringMode == 1)
+
+//adcInterruptRoutine
+void CVSLE::adcInterruptRoutine()
+{
+
+	//Variables
+	int sample=ADC;
+
+	//Voltage sample, switch to current channel and chain next conversion
+	if(_meterVoltagePhase){
+
+		_meterVoltage=sample-CVSLE_voltageZero;
+		_meterVoltagePhase=false;
+		_meterSelect(CVSLE_currentChannel);
+		ADCSRA |= (1 << ADSC);
+
+		return;
+
+	}//EOP voltage sample
+
+	//Current sample, pair with last voltage sample
+	int current=sample-CVSLE_currentZero;
+	int voltage=_meterVoltage;
+
+	_meterVoltagePhase=true;
+	_meterSelect(CVSLE_voltageChannel);
+	ADCSRA |= (1 << ADSC);
+
+	//Accumulate in integer counts
+	_sumV2+=(int32_t)voltage*voltage;
+	_sumI2+=(int32_t)current*current;
+	_sumVI+=(int32_t)voltage*current;
+	_samples++;
+
+#if (CVSLE_thermalMode == 1)
+
+	//Triac loss needs the mean of |I| too
+	_thermalRunI+=abs(current);
+
+#endif
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	//Track peak of this half cycle
+	if((uint16_t)abs(current)>_currentPeakRun){
+
+		_currentPeakRun=abs(current);
+
+	}//EOP new peak
+
+#endif
+
+#if (CVSLE_loadIDMode == 1)
+
+	//Load test sample
+	_loadIDSample(abs(current));
+
+#endif
+
+
+}//EOP adcInterruptRoutine
+
+
+//Select ADC channel
+void CVSLE::_meterSelect(byte channel){
+
+	ADMUX = (1 << REFS0) | (channel & 0x07);   // AVcc reference
+#if defined(MUX5)
+	ADCSRB = (channel > 7) ? (1 << MUX5) : 0;
+#else
+	ADCSRB = 0;
+#endif
+
+}//EOP _meterSelect
+
+
+//get RMS voltage
+float CVSLE::getRMSVoltage(){
+
+	//Variables
+	int32_t sumV2;
+	uint16_t samples;
+
+	noInterrupts();
+	sumV2=_meterV2;
+	samples=_meterN;
+	interrupts();
+
+	//Check samples
+	if(samples==0){
+
+		return 0;
+
+	}//EOP no samples
+
+	//Return
+	return sqrt((float)sumV2/samples)*CVSLE_voltageScale;
+
+}//EOP getRMSVoltage
+
+
+//get RMS current
+float CVSLE::getRMSCurrent(){
+
+	//Variables
+	int32_t sumI2;
+	uint16_t samples;
+
+	noInterrupts();
+	sumI2=_meterI2;
+	samples=_meterN;
+	interrupts();
+
+	//Check samples
+	if(samples==0){
+
+		return 0;
+
+	}//EOP no samples
+
+	//Return
+	return sqrt((float)sumI2/samples)*CVSLE_currentScale;
+
+}//EOP getRMSCurrent
+
+
+//get real power
+float CVSLE::getRealPower(){
+
+	//Variables
+	int32_t sumVI;
+	uint16_t samples;
+
+	noInterrupts();
+	sumVI=_meterVI;
+	samples=_meterN;
+	interrupts();
+
+	//Check samples
+	if(samples==0){
+
+		return 0;
+
+	}//EOP no samples
+
+	//Return
+	return ((float)sumVI/samples)*CVSLE_voltageScale*CVSLE_currentScale;
+
+}//EOP getRealPower
+
+
+//get energy
+float CVSLE::getEnergy(){
+
+	//Variables
+	int64_t energyAcc;
+
+	noInterrupts();
+	energyAcc=_energyAcc;
+	interrupts();
+
+	//Counts x ZD ticks (16us) to watt hours
+	return (float)energyAcc*CVSLE_voltageScale*CVSLE_currentScale*(CVSLE_ZDTickUS/3600000000.0);
+
+}//EOP getEnergy
+
+
+//reset energy
+void CVSLE::resetEnergy(){
+
+	noInterrupts();
+	_energyAcc=0;
+	interrupts();
+
+}//EOP resetEnergy
+
+#elif (CVSLE_adaptiveStartMode == 1)
+
+//adcInterruptRoutine
+void CVSLE::adcInterruptRoutine()
+{
+
+	//Variables
+	int sample=ADC;
+	uint16_t current=abs(sample-CVSLE_currentZero);
+
+	//Track peak of this half cycle
+	if(current>_currentPeakRun){
+
+		_currentPeakRun=current;
+
+	}//EOP new peak
+
+#if (CVSLE_loadIDMode == 1)
+
+	//Load test sample
+	_loadIDSample(current);
+
+#endif
+
+
+}//EOP adcInterruptRoutine
+
+#endif
+
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+//Static wrapper for ZD during calibration
+void CVSLE::_ZDCalRoutine()
+{
+
+	//Check edge
+	if(digitalRead(cvsLE._interruptPin)==((CVSLE_ZDMode==RISING)?HIGH:LOW)){
+
+		//Zero detect edge, normal routine
+		_ZDRoutine();
+
+		//Length of the half cycle just finished
+		if(cvsLE._ZDCounter>0){
+
+			cvsLE._calPeriod[cvsLE._ZDParity^1]+=cvsLE._ZDCounter;
+			cvsLE._calPeriodCount[cvsLE._ZDParity^1]++;
+
+		}//EOP valid period
+
+	}//EOP zero detect edge
+	else{
+
+		//Other edge
+		cvsLE.zeroDetectCalISR();
+
+	}//EOP other edge
+
+}
+
+
+//Calibration routine for the other edge
+void CVSLE::zeroDetectCalISR()
+{
+
+	//Time since zero detect edge
+	_calHigh[_ZDParity]+=_ZDElapsed();
+	_calCount[_ZDParity]++;
+
+
+}//EOP zeroDetectCalISR
+
+#endif
+
+
+#if (CVSLE_eventSystemMode == 1)
+
+//TCB clock from TCA0, naming differs between megaAVR-0 and AVR-Dx
+#if defined(TCB_CLKSEL_TCA0_gc)
+#define CVSLE_eventTCBClock TCB_CLKSEL_TCA0_gc
+#else
+#define CVSLE_eventTCBClock TCB_CLKSEL_CLKTCA_gc
+#endif
+
+
+//Event system begin
+byte CVSLE::_eventSystemBegin()
+{
+
+	//Variables
+	byte result=1;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Zero-detect pin => event channel 0 => TCB0 and TCB2
+	 * 2) TCB0 capture (end of firing delay) => event channel 1 => TCB1
+	 * 3) TCB0 single shot, CCMP is the firing delay
+	 * 4) TCB1 single shot, CCMP is the gate pulse, drives its WO pin
+	 * 5) TCB2 frequency measurement, CCMP is the ZD period
+	 * 6) Pins
+	 *
+	 */
+
+
+	noInterrupts();
+
+	//Step 1, 2 => Event routing
+#if defined(EVSYS_CHANNEL0_PORTA_PIN0_gc)
+
+	EVSYS.CHANNEL0=EVSYS_CHANNEL0_PORTA_PIN0_gc+CVSLE_eventZDPin;
+	EVSYS.CHANNEL1=EVSYS_CHANNEL1_TCB0_CAPT_gc;
+	EVSYS.USERTCB0CAPT=EVSYS_USER_CHANNEL0_gc;
+	EVSYS.USERTCB2CAPT=EVSYS_USER_CHANNEL0_gc;
+	EVSYS.USERTCB1CAPT=EVSYS_USER_CHANNEL1_gc;
+
+#else
+
+	EVSYS.CHANNEL0=EVSYS_GENERATOR_PORT0_PIN0_gc+CVSLE_eventZDPin;
+	EVSYS.CHANNEL1=EVSYS_GENERATOR_TCB0_CAPT_gc;
+	EVSYS.USERTCB0=EVSYS_CHANNEL_CHANNEL0_gc;
+	EVSYS.USERTCB2=EVSYS_CHANNEL_CHANNEL0_gc;
+	EVSYS.USERTCB1=EVSYS_CHANNEL_CHANNEL1_gc;
+
+#endif
+
+	//Step 3 => Firing delay
+	TCB0.CTRLA=0;
+	TCB0.CTRLB=TCB_CNTMODE_SINGLE_gc;
+	TCB0.EVCTRL=TCB_CAPTEI_bm;   // start on rising edge
+	TCB0.CCMP=_firingDelay*CVSLE_eventTickScale;
+	TCB0.CTRLA=CVSLE_eventTCBClock | TCB_ENABLE_bm;
+
+	//Step 4 => Gate pulse, output enabled while motor runs
+	TCB1.CTRLA=0;
+	TCB1.CTRLB=TCB_CNTMODE_SINGLE_gc;
+	TCB1.EVCTRL=TCB_CAPTEI_bm;
+	TCB1.CCMP=CVSLE_triacDriverDelay*CVSLE_eventTickScale;
+	TCB1.CTRLA=CVSLE_eventTCBClock | TCB_ENABLE_bm;
+
+	//Step 5 => ZD period
+	TCB2.CTRLA=0;
+	TCB2.CTRLB=TCB_CNTMODE_FRQ_gc;
+	TCB2.EVCTRL=TCB_CAPTEI_bm;
+	TCB2.CTRLA=CVSLE_eventTCBClock | TCB_ENABLE_bm;
+
+	_eventDelay=_firingDelay;
+	_eventCaptureAt=0;
+
+	interrupts();
+
+	//Step 6 => Pins, triacDriverPin must be the TCB1 WO pin
+	if(_inputPullupINT){
+
+		pinMode(_interruptPin, INPUT_PULLUP);
+
+	}//EOP check flag
+	else{
+
+		pinMode(_interruptPin, INPUT);
+
+	}//EOP no pullup
+
+	pinMode(_triacDriverPin,OUTPUT);
+	digitalWrite(_triacDriverPin,LOW);
+
+	pinMode(_loadRelayPin,OUTPUT);
+
+	//Return statement
+	return result;
+
+}//EOP _eventSystemBegin
+
+
+//Event system apply
+void CVSLE::_eventSystemApply()
+{
+
+	//Check firing delay
+	if(_firingDelay!=_eventDelay){
+
+		TCB0.CCMP=_firingDelay*CVSLE_eventTickScale;
+
+		_eventDelay=_firingDelay;
+
+	}//EOP ramp step
+
+	//Hardware gate pulses only while ramping, pin is held by software otherwise
+	if( motorStatus && (!_absMotorFlag) ){
+
+		TCB1.CTRLB=TCB_CNTMODE_SINGLE_gc | TCB_CCMPEN_bm;
+
+	}//EOP pulses
+	else{
+
+		TCB1.CTRLB=TCB_CNTMODE_SINGLE_gc;
+
+	}//EOP no pulses
+
+
+}//EOP _eventSystemApply
+
+
+//Event system period
+void CVSLE::_eventSystemPeriod()
+{
+
+	//Variables
+	uint16_t period;
+
+	//Capture flag latches a crossing, CNT wraps too often to tell mains loss
+	if(TCB2.INTFLAGS & TCB_CAPT_bm){
+
+		_eventCaptureAt=millis();
+
+	}//EOP crossing since last call
+
+	//Reading CCMP clears the capture flag in frequency mode
+	period=TCB2.CCMP/CVSLE_eventTickScale;
+
+	//No crossing for longer than a valid period
+	if( (millis()-_eventCaptureAt)>CVSLE_ZDTP ){
+
+		period=0;
+
+	}//EOP no mains
+
+	_ZDCounter=period;
+
+
+}//EOP _eventSystemPeriod
+
+#endif
@@ -7,6 +7,9 @@
  * operating speed, frequency monitoring and direct load control.
  *
  * WORKS ONLY IN AVR Architecture boards. Needs two 16 bit timers for better efficiency.
+ * On megaAVR-0/AVR-Dx parts CVSLE_eventSystemMode runs the zero-detect to gate
+ * path on the event system and TCB0..TCB2 instead; triacDriverPin must then be
+ * the TCB1 WO pin and the zero-detect input the PORTA bit CVSLE_eventZDPin.
  *
  * Designed specifically to work with any triac/triac-driver circuit with in built
  * zero-detect. The original purpose of this library is for Saryam's "Centralized
@@ -53,10 +56,135 @@
 #define CVSLE_PTTCDIV 100 //Divisions for soft start time period
 #define CVSLE_ZDMTC 1250 //Max counter value for ZD
 #define CVSLE_ZDTP 20 //Input AC time period in milliSecs
+#define CVSLE_ZDTickUS 16 //ZD timer tick in microSecs (256 prescaler at 16MHz)
+#define CVSLE_timerPrescaler 256 //PT and ZD timer prescaler, sets CVSLETicks
 #define CVSLE_ZDF 50 //Input AC frequency in Hz
 
 #define CVSLE_ZDMode RISING //Mode for interrupt attach of zero-detect
 
+#define CVSLE_hookMode 0 //Inlined hooks from CVSLEHooks.h (1) or attachRoutineFor* function pointers (0)
+
+#define CVSLE_singleTimerMode 0 //Free running Timer1 for both ZD period and firing (1) or two timers (0)
+
+#define CVSLE_eventSystemMode 0 //megaAVR-0/AVR-Dx event system and TCB backend (1) or timer ISR backend (0)
+#define CVSLE_eventZDPin 2 //Zero-detect input bit on PORTA, routed to event channel 0
+#define CVSLE_eventTickScale 4 //TCB ticks (TCA0 clock, DIV64) per PT count (256 prescaler)
+
+#define CVSLE_threePhaseMode 0 //Three phase mode (1) or single phase mode (0)
+#define CVSLE_interruptB 19 //Zero-detect Interrupt pin for phase B
+#define CVSLE_interruptC 20 //Zero-detect Interrupt pin for phase C
+#define CVSLE_triacDriverB 7 //TriacDriver enable pin for phase B
+#define CVSLE_triacDriverC 8 //TriacDriver enable pin for phase C
+#define CVSLE_phaseTolerance 25 //Allowed deviation from 120 degree spacing in ZD counts
+
+#define CVSLE_adaptiveStartMode 0 //Current limited soft start (1) or time based soft start (0)
+#define CVSLE_currentChannel 0 //ADC channel of load current sensor
+#define CVSLE_currentZero 512 //ADC count of load current sensor at zero current
+#define CVSLE_currentLimit 300 //Peak load current limit in ADC counts from CVSLE_currentZero
+#define CVSLE_adaptiveStepTC 5 //Firing delay change per half cycle during adaptive start in PT counts
+#define CVSLE_currentTripCycles 50 //Half cycles in a row above the current limit before CVSLE_faultCurrent, adaptive hold back clears a normal start well within it
+
+#define CVSLE_meteringMode 0 //Zero-cross synchronised RMS and power metering (1) or not (0)
+#define CVSLE_voltageChannel 1 //ADC channel of mains voltage sensor
+#define CVSLE_voltageZero 512 //ADC count of mains voltage sensor at zero volts
+#define CVSLE_voltageScale 0.625 //Volts per ADC count of voltage sensor
+#define CVSLE_currentScale 0.0264 //Amps per ADC count of load current sensor
+
+#define CVSLE_pulseTrainMode 0 //Gate pulse train every half cycle (1) or continuous gate at full load (0)
+#define CVSLE_pulseCount 3 //Gate pulses per half cycle in pulse train mode
+#define CVSLE_pulseCountMax 4 //Max gate pulses per half cycle
+#define CVSLE_pulseWidth 5 //Gate pulse width in PT counts
+#define CVSLE_pulseSpacing 10 //Gap between gate pulses in PT counts
+#define CVSLE_pulseTrainFullTC 2 //Train start after zero-cross at full load in PT counts
+#define CVSLE_pulseTrainEndTC 615 //Latest PT count a train pulse may end, short of next zero-cross
+
+#define CVSLE_ZDCalibrationMode 0 //Apply per board zero-detect offset to firing delays (1) or not (0)
+#define CVSLE_ZDCalCycles 50 //Half cycles measured by calibrateZeroDetect
+#define CVSLE_ZDOffsetMax 100 //Max allowed zero-detect offset in PT counts
+
+#define CVSLE_powerQualityMode 0 //Mains power quality monitor (1) or not (0)
+#define CVSLE_pqWindow 100 //Half cycles per statistics window, max 255
+#define CVSLE_pqNominalTC 625 //Nominal half cycle in ZD counts
+#define CVSLE_pqBins 16 //Period histogram bins
+#define CVSLE_pqBinShift 2 //Histogram bin width, 2^shift ZD counts
+#define CVSLE_pqGlitchTC 500 //Shorter ZD period is a glitch, not a half cycle
+#define CVSLE_pqDropoutTC 940 //Longer ZD period is a dropout, not a half cycle
+
+#define CVSLE_scheduleMode 0 //Start/stop/load max scheduled on half cycle counts and run from the ZD ISR (1) or not (0)
+#define CVSLE_scheduleSlots 8 //Pending scheduled actions
+#define CVSLE_actionStart 1 //Scheduled action, soft start ramped from the ZD ISR
+#define CVSLE_actionStop 2 //Scheduled action, stop load
+#define CVSLE_actionLoadMax 3 //Scheduled action, change load max % to value
+
+#define CVSLE_thermalMode 0 //Triac junction temperature estimate with load derating (1) or not (0)
+#define CVSLE_thermalAmbient 40.0 //Default ambient temperature in degC
+#define CVSLE_thermalRth 1.5 //Junction to ambient thermal resistance incl. heatsink in degC/W
+#define CVSLE_thermalTau 90.0 //Heatsink thermal time constant in secs
+#define CVSLE_thermalLoss 12.0 //Triac dissipation at full conduction in W, used without metering
+#define CVSLE_thermalVT0 1.0 //Triac on-state threshold voltage in V, used with metering
+#define CVSLE_thermalRD 0.02 //Triac on-state slope resistance in ohms, used with metering
+#define CVSLE_thermalDerateStart 100.0 //Junction temperature where derating begins in degC
+#define CVSLE_thermalLimit 125.0 //Junction temperature where conduction reaches zero in degC
+#define CVSLE_thermalStepCycles 10 //Half cycles folded into each model step
+
+#define CVSLE_loadIDMode 0 //Load type identification and firing strategy selection (1) or not (0)
+#define CVSLE_loadIDCycles 20 //Half cycles fired at each test firing delay
+#define CVSLE_loadIDTestTCA 450 //First test firing delay, late and gentle, in PT counts
+#define CVSLE_loadIDTestTCB 300 //Second test firing delay, about half conduction, in PT counts
+#define CVSLE_loadIDThreshold 20 //Current in ADC counts from CVSLE_currentZero treated as conducting
+#define CVSLE_loadIDLagTC 20 //Current past zero-cross above this marks an inductive load, in ZD counts
+#define CVSLE_loadIDCrest 4 //Peak to mean conducting current above this marks a capacitive load
+#define CVSLE_loadIDDrift 15 //Fall of peak current across a test in % that marks a motor
+#define CVSLE_loadIDMarginTC 10 //Firing delay kept past the measured current lag in PT counts
+#define CVSLE_loadIDGateTC 30 //Gate pulse for inductive loads, long enough to latch, in PT counts
+
+//Load types
+#define CVSLE_loadUnknown 0 //No current seen, defaults kept
+#define CVSLE_loadResistive 1 //Heater or lamp, integral cycle firing
+#define CVSLE_loadInductive 2 //Transformer or coil, phase angle past the current lag
+#define CVSLE_loadMotor 3 //Universal motor, phase angle past the current lag
+#define CVSLE_loadCapacitive 4 //Capacitive input, integral cycle to avoid switching spikes
+
+#define CVSLE_timeBaseMode 0 //Ramps and timeouts on a mains-locked half cycle clock (1) or millis() (0)
+#define CVSLE_timeNominalTC 625 //ZD counts per half cycle while running on the crystal
+#define CVSLE_timeGlitchTC 500 //Shorter ZD period is a glitch, kept as crystal time
+
+#define CVSLE_bypassMode 0 //Bypass contactor across the triac at full load (1) or triac only (0)
+#define CVSLE_bypassPin 9 //Bypass contactor enable pin
+#define CVSLE_bypassOperateCycles 6 //Half cycles the triac keeps conducting while the contactor closes
+#define CVSLE_bypassReleaseCycles 6 //Half cycles the triac conducts while the contactor opens
+
+//Bypass states
+#define CVSLE_bypassOpen 0 //Triac firing
+#define CVSLE_bypassClosing 1 //Contactor closing across the conducting triac
+#define CVSLE_bypassClosed 2 //Contactor carries the load, firing suspended
+#define CVSLE_bypassOpening 3 //Triac held ON while the contactor opens
+
+#define CVSLE_relaySyncMode 0 //Load relay contacts switched at zero-cross (1) or at once (0)
+#define CVSLE_relayOperateUS 8000 //Configured coil ON to contacts made delay in microSecs
+#define CVSLE_relayReleaseUS 4000 //Configured coil OFF to contacts open delay in microSecs
+#define CVSLE_relaySensePin 255 //Auxiliary contact input on an external interrupt pin, 255 for none
+#define CVSLE_relaySenseClosed HIGH //Auxiliary contact input level with the contacts made
+#define CVSLE_relayGuardTC 10 //Coil command this close to the next zero-cross moves to the crossing, in ZD counts
+#define CVSLE_relayTimeoutTC 3125 //No auxiliary contact change within this flags the relay, in ZD counts
+#define CVSLE_relayDrift 25 //Learned delay above configured by this % flags the relay
+
+#define CVSLE_stateMotor 0x01 //State bit, motorStatus
+#define CVSLE_stateMotorMax 0x02 //State bit, motorMaxFlag
+#define CVSLE_stateAbsMax 0x04 //State bit, absolute load max reached
+#define CVSLE_stateOddHalf 0x08 //State bit, odd half cycle
+#define CVSLE_stateBypass 0x10 //State bit, bypass contactor closed
+
+#define CVSLE_faultZDPeriod 0x01 //Fault bit, ZD period out of range
+#define CVSLE_faultPhase 0x02 //Fault bit, three phase check failed
+#define CVSLE_faultCurrent 0x04 //Fault bit, load current above limit for CVSLE_currentTripCycles
+#define CVSLE_faultRelay 0x08 //Fault bit, load relay slow or auxiliary contact silent
+
+#define CVSLE_phaseOK 0 //All phases present, ABC sequence and 120 degree spacing
+#define CVSLE_phaseMissing 1 //One or more phase crossings missing in last half cycle
+#define CVSLE_phaseSequence 2 //Phases present but in ACB sequence
+#define CVSLE_phaseSpacing 3 //Phases present but not spaced 120 degrees apart
+
 #if (CVSLE_ProcessTimer==2)
 #define CVSLE_PTimerMax 255 //Timer max
 #else
@@ -64,6 +192,73 @@
 #endif
 
 
+#if (CVSLE_singleTimerMode == 1) && (CVSLE_ProcessTimer != 1)
+#error "CVSLE_singleTimerMode needs CVSLE_ProcessTimer 1"
+#endif
+
+#if (CVSLE_singleTimerMode == 1) && (CVSLE_threePhaseMode == 1)
+#error "CVSLE_singleTimerMode does not support CVSLE_threePhaseMode"
+#endif
+
+#if (CVSLE_eventSystemMode == 1) && ( (CVSLE_threePhaseMode == 1) || (CVSLE_singleTimerMode == 1) || (CVSLE_pulseTrainMode == 1) || (CVSLE_ZDCalibrationMode == 1) || (CVSLE_adaptiveStartMode == 1) || (CVSLE_meteringMode == 1) )
+#error "CVSLE_eventSystemMode runs without CPU ISRs and supports none of the ISR based modes"
+#endif
+
+#if (CVSLE_powerQualityMode == 1) && ( (CVSLE_singleTimerMode == 1) || (CVSLE_eventSystemMode == 1) )
+#error "CVSLE_powerQualityMode needs the separate ZD timer and its overflow ISR"
+#endif
+
+#if (CVSLE_scheduleMode == 1) && (CVSLE_eventSystemMode == 1)
+#error "CVSLE_scheduleMode runs from the zero-detect ISR, not available with CVSLE_eventSystemMode"
+#endif
+
+#if (CVSLE_thermalMode == 1) && (CVSLE_eventSystemMode == 1)
+#error "CVSLE_thermalMode counts conduction in the zero-detect ISR, not available with CVSLE_eventSystemMode"
+#endif
+
+#if (CVSLE_loadIDMode == 1) && ( (CVSLE_adaptiveStartMode == 0) && (CVSLE_meteringMode == 0) )
+#error "CVSLE_loadIDMode samples load current, enable CVSLE_adaptiveStartMode or CVSLE_meteringMode"
+#endif
+
+#if (CVSLE_loadIDMode == 1) && ( (CVSLE_singleTimerMode == 1) || (CVSLE_threePhaseMode == 1) )
+#error "CVSLE_loadIDMode supports the two timer single phase backend only"
+#endif
+
+#if (CVSLE_timeBaseMode == 1) && ( (CVSLE_singleTimerMode == 1) || (CVSLE_eventSystemMode == 1) )
+#error "CVSLE_timeBaseMode falls back on the ZD timer overflow, two timer ISR backend only"
+#endif
+
+#if (CVSLE_bypassMode == 1) && (CVSLE_eventSystemMode == 1)
+#error "CVSLE_bypassMode hands over in the zero-detect ISR, not available with CVSLE_eventSystemMode"
+#endif
+
+#if (CVSLE_relaySyncMode == 1) && ( (CVSLE_singleTimerMode == 1) || (CVSLE_eventSystemMode == 1) )
+#error "CVSLE_relaySyncMode times the coil on the ZD timer compare, two timer ISR backend only"
+#endif
+
+
+#include "CVSLETime.h"
+
+static_assert(CVSLE_tickNS==(CVSLE_ZDTickUS*1000UL), "CVSLE_ZDTickUS does not match F_CPU and CVSLE_timerPrescaler");
+
+#if (CVSLE_timeBaseMode == 1)
+typedef CVSLEHalfCycles CVSLETimeUnit; //Ramp and timeout clock, mains-locked half cycles
+#else
+typedef CVSLEMillis CVSLETimeUnit; //Ramp and timeout clock, millis()
+#endif
+
+#if (CVSLE_eventSystemMode == 1) && !defined(TCB2)
+#error "CVSLE_eventSystemMode needs a megaAVR-0 or AVR-Dx part with TCB0..TCB2"
+#endif
+
+
+#if (CVSLE_pulseTrainMode == 1)
+#define CVSLE_gateEvents (6*CVSLE_pulseCountMax) //Three phase schedule size
+#else
+#define CVSLE_gateEvents 6 //Three phase schedule size
+#endif
+
+
 #if (CVSLE_ZDTimer==2)
 #define CVSLE_ZDTimerMax 255 //Timer max
 #else
@@ -105,6 +300,12 @@ public:
 	 * @return void
 	 */
 
+	void setSoftStartInterval(CVSLESeconds softStartInterval);
+	/*!
+	 * @brief Set the current soft start interval, e.g. CVSLESeconds(20)
+	 * @return void
+	 */
+
 	byte getLoadMax();
 	/*!
 	 * @brief Get the Load Max Value %
@@ -153,103 +354,973 @@ public:
 	 */
 
 
-	//****************************
-	//  Interrupt Function
-	//****************************
-	void attachRoutineForCompare(void (*isr)()) __attribute__((always_inline)) {
+	byte getStateBits();
+	/*!
+	 * @brief Get load state as CVSLE_state* bits
+	 * @return State bits
+	 */
 
-		isrCompare = isr;
 
-	}
+	byte getFaultBits();
 	/*!
-	 * @brief Attach Interrupt for when Compare ISR is triggered.
+	 * @brief Get active faults as CVSLE_fault* bits
+	 * @return Fault bits, 0 when healthy
+	 */
+
+
+#if (CVSLE_powerQualityMode == 1)
+
+	float getPeriodMin();
+	/*!
+	 * @brief Get shortest half cycle of the last statistics window
+	 * @return Period in microSecs, 0 before the first window
+	 */
+
+
+	float getPeriodMax();
+	/*!
+	 * @brief Get longest half cycle of the last statistics window
+	 * @return Period in microSecs, 0 before the first window
+	 */
+
+
+	float getPeriodMean();
+	/*!
+	 * @brief Get mean half cycle of the last statistics window
+	 * @return Period in microSecs, 0 before the first window
+	 */
+
+
+	float getPeriodVariance();
+	/*!
+	 * @brief Get half cycle variance of the last statistics window
+	 * @return Variance in microSecs squared
+	 */
+
+
+	float getRoCoF();
+	/*!
+	 * @brief Get rate of change of frequency between the last two windows
+	 * @return RoCoF in Hz per second
+	 */
+
+
+	uint16_t getPeriodHistogram(byte bin);
+	/*!
+	 * @brief Get half cycles counted in histogram bin since reset. Bin
+	 * CVSLE_pqBins/2 starts at CVSLE_pqNominalTC, bins are 2^CVSLE_pqBinShift
+	 * ZD counts wide and the end bins collect everything beyond
+	 * @return Count, saturates at 65535
+	 */
+
+
+	uint16_t getDropoutCount();
+	/*!
+	 * @brief Get zero-cross gaps longer than CVSLE_pqDropoutTC since reset
+	 * @return Dropout count
+	 */
+
+
+	uint16_t getGlitchCount();
+	/*!
+	 * @brief Get zero-cross edges closer than CVSLE_pqGlitchTC since reset
+	 * @return Glitch count
+	 */
+
+
+	unsigned long getLongestDropout();
+	/*!
+	 * @brief Get longest zero-cross gap since reset
+	 * @return Gap in milliSecs
+	 */
+
+
+	void resetPowerQuality();
+	/*!
+	 * @brief Clear histogram, dropout and glitch counters
 	 * @return void
 	 */
 
-	void attachRoutineForOverflow(void (*isr)()) __attribute__((always_inline)) {
+#endif
 
-		isrOverflow = isr;
 
-	}
+#if (CVSLE_scheduleMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	uint32_t getHalfCycleCount();
 	/*!
-	 * @brief Attach Interrupt for when Overflow ISR is triggered.
+	 * @brief Get zero-crossings seen since begin, two per mains cycle. With
+	 * CVSLE_timeBaseMode the count carries on by the crystal while mains is
+	 * absent and wraps after about 1.3 years at 50 Hz
+	 * @return Half cycle count
+	 */
+
+#endif
+
+
+#if (CVSLE_scheduleMode == 1)
+
+	byte scheduleAt(uint32_t halfCycle, byte action, byte value=0);
+	/*!
+	 * @brief Run action at the zero-cross where the half cycle count reaches
+	 * halfCycle, at the next one if already passed. While a scheduled start is
+	 * active the ZD ISR ramps the load itself, the sketch must not call
+	 * startLoadSoft or stopLoad
+	 * @return Returns "1" for success and "0" for full queue or bad action
+	 */
+
+
+	byte scheduleAfter(uint32_t halfCycles, byte action, byte value=0);
+	/*!
+	 * @brief Run action halfCycles zero-crossings from now
+	 * @return Returns "1" for success and "0" for full queue or bad action
+	 */
+
+
+	byte scheduleAfter(CVSLEHalfCycles delay, byte action, byte value=0);
+	/*!
+	 * @brief Run action after delay, e.g. CVSLESeconds(5) at 50 Hz; finer
+	 * units, and seconds at 60 Hz, need cvsleDurationCast<CVSLEHalfCycles>
+	 * @return Returns "1" for success and "0" for full queue or bad action
+	 */
+
+
+	void clearSchedule();
+	/*!
+	 * @brief Drop all pending actions, a running scheduled load keeps running
 	 * @return void
 	 */
 
-	static void (*isrCompare)();
-	/*
-	 * @brief Stored custom function for compare ISR
+
+	byte getScheduleCount();
+	/*!
+	 * @brief Get pending scheduled actions
+	 * @return Action count
 	 */
 
-	static void (*isrOverflow)();
-	/*
-	 * @brief Stored custom function for compare ISR
+
+	bool getScheduledRun();
+	/*!
+	 * @brief Get whether a scheduled start is driving the load
+	 * @return Returns true between scheduled start and stop
 	 */
 
-	static void isrDefaultUnused();
-	/*
-	 * @brief Default function for interrupts
+#endif
+
+
+#if (CVSLE_thermalMode == 1)
+
+	float getJunctionTemperature();
+	/*!
+	 * @brief Fold half cycles counted since the last step into the thermal
+	 * model and get the estimate. startLoadSoft and startLoadHard step the
+	 * model themselves, call this from loop() while the load is stopped or
+	 * driven by a scheduled start
+	 * @return Returns junction temperature in degC
 	 */
 
-	void compareInterruptRoutine();
-	/*
-	 * @brief Custom function for compareISR
+
+	byte getThermalDerate();
+	/*!
+	 * @brief Get share of the firing range still allowed by the thermal model
+	 * @return Returns 100 when not derating, 0 at CVSLE_thermalLimit
 	 */
 
-	void overflowInterruptRoutine();
-	/*
-	 * @brief Custom function for overflowISR
+
+	void setAmbientTemperature(float ambient);
+	/*!
+	 * @brief Set ambient temperature, e.g. from an enclosure sensor
+	 * @return void
 	 */
 
-	void zeroDetectISR();
-	/*
-	 * @brief CISR for zero detect
+#endif
+
+
+#if (CVSLE_loadIDMode == 1)
+
+	byte identifyLoad(byte halfCycles=CVSLE_loadIDCycles);
+	/*!
+	 * @brief Fire the load OFF state at two test firing delays, measure current
+	 * lag past zero-cross, crest and drift, classify the load and select the
+	 * firing strategy. Blocks for about 2*halfCycles half cycles
+	 * @return CVSLE_loadUnknown, Resistive, Inductive, Motor or Capacitive
 	 */
 
-	void ZDTimerCalC();
-	/*
-	 * @brief Routine for ZD Time for calculation time period of input signal
+
+	byte getLoadType();
+	/*!
+	 * @brief Get load type of the last identification or setLoadType
+	 * @return CVSLE_load* type
 	 */
 
-private:
 
-	byte _interruptPin;
-	byte _triacDriverPin;
-	byte _softStartInterval;
-	byte _loadRelayPin;
-	byte _motorMax;
-	uint16_t volatile _ZDCounter;
-	byte _ZDTD;
-	bool _inputPullupINT;
-	unsigned long _currentLoadStart;
-	unsigned long _previousLoadStart;
-	byte _softStartIntervalCount;
-	boolean _absMotorFlag;
+	void setLoadType(byte loadType, uint16_t lagTC=0);
+	/*!
+	 * @brief Select firing strategy for a known load, e.g. stored from an
+	 * earlier identifyLoad. Ignored while the load is ON
+	 * @return void
+	 */
 
 
-	uint16_t volatile *  _timerCounter_P;
-	uint16_t volatile *  _outputCompare_P;
-	uint16_t volatile *  _inputCompare_P;
-	uint8_t volatile *  _timerMode_P;
-	uint8_t volatile *  _prescaler_P;
-	uint8_t volatile *  _interruptMask_P;
-	uint8_t volatile *  _interruptflag_P;
+	uint16_t getLoadLag();
+	/*!
+	 * @brief Get current lag past zero-cross measured by identifyLoad
+	 * @return Lag in ZD counts
+	 */
 
 
-	uint16_t volatile *  _timerCounter_ZD;
-	uint16_t volatile *  _outputCompare_ZD;
-	uint16_t volatile *  _inputCompare_ZD;
-	uint8_t volatile *  _timerMode_ZD;
-	uint8_t volatile *  _prescaler_ZD;
-	uint8_t volatile *  _interruptMask_ZD;
-	uint8_t volatile *  _interruptflag_ZD;
+	bool getIntegralCycle();
+	/*!
+	 * @brief Get whether whole cycles are switched at zero-cross instead of
+	 * phase angle firing
+	 * @return Returns true for integral cycle firing
+	 */
 
+#endif
 
-	static void _ZDRoutine();
+
+#if (CVSLE_timeBaseMode == 1)
+
+	unsigned long getTimeMillis();
+	/*!
+	 * @brief Get time base in milliSecs at nominal mains frequency, a
+	 * millis() replacement with half cycle resolution
+	 * @return milliSecs since begin
+	 */
+
+
+	bool getTimeBaseLocked();
+	/*!
+	 * @brief Get whether the time base is following mains zero-crossings
+	 * @return Returns true when locked to mains and false on the crystal
+	 */
+
+#endif
+
+
+#if (CVSLE_bypassMode == 1)
+
+	byte getBypassState();
+	/*!
+	 * @brief Get bypass contactor state
+	 * @return CVSLE_bypassOpen, Closing, Closed or Opening
+	 */
+
+#endif
+
+
+#if (CVSLE_relaySyncMode == 1)
+
+	uint16_t getRelayOperateDelay();
+	/*!
+	 * @brief Get coil ON to contacts made delay, learned from the auxiliary
+	 * contact or as configured
+	 * @return Delay in microSecs
+	 */
+
+
+	uint16_t getRelayReleaseDelay();
+	/*!
+	 * @brief Get coil OFF to contacts open delay, learned from the auxiliary
+	 * contact or as configured
+	 * @return Delay in microSecs
+	 */
+
+
+	void setRelayDelay(uint16_t operateUS, uint16_t releaseUS);
+	/*!
+	 * @brief Set operate and release delays, e.g. from the relay datasheet,
+	 * also the reference for getRelayDegraded
+	 * @return void
+	 */
+
+
+	bool getRelayDegraded();
+	/*!
+	 * @brief Get whether a learned delay drifted past CVSLE_relayDrift or
+	 * the auxiliary contact did not follow the coil
+	 * @return Returns true for a relay due for replacement
+	 */
+
+
+	void ZDCompareRoutine();
 	/*
-	 * @brief ZD Static wrapper
+	 * @brief Custom function for ZD timer compare ISR
 	 */
 
+#endif
+
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	void setGatePulseTrain(byte pulseCount=CVSLE_pulseCount, byte pulseWidth=CVSLE_pulseWidth, byte pulseSpacing=CVSLE_pulseSpacing);
+	/*!
+	 * @brief Set gate pulse count, width and spacing (PT counts) per half cycle
+	 * @return void
+	 */
+
+#endif
+
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	byte calibrateZeroDetect(byte halfCycles=CVSLE_ZDCalCycles);
+	/*!
+	 * @brief Measure both edges of the zero-detect pulse with the load OFF and
+	 * derive the offset from detected edge to true zero for each half cycle.
+	 * Blocks for about halfCycles half cycles
+	 * @return Returns "1" for success and "0" for failure
+	 */
+
+
+	int getZDOffset(byte halfCycle);
+	/*!
+	 * @brief Get zero-detect offset of even (0) or odd (1) half cycles
+	 * @return Offset in PT counts, positive when true zero is after the edge
+	 */
+
+
+	void setZDOffset(int offsetEven, int offsetOdd);
+	/*!
+	 * @brief Set zero-detect offsets, e.g. restored from EEPROM
+	 * @return void
+	 */
+
+#endif
+
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	uint16_t getCurrentLimit();
+	/*!
+	 * @brief Get the adaptive soft start current limit
+	 * @return Returns the limit in ADC counts
+	 */
+
+
+	void setCurrentLimit(uint16_t currentLimit=CVSLE_currentLimit);
+	/*!
+	 * @brief Set the adaptive soft start current limit in ADC counts
+	 * @return void
+	 */
+
+
+	uint16_t getLoadCurrentPeak();
+	/*!
+	 * @brief Get peak load current of the last half cycle
+	 * @return Returns the peak in ADC counts from CVSLE_currentZero
+	 */
+
+#endif
+
+
+#if (CVSLE_meteringMode == 1)
+
+	float getRMSVoltage();
+	/*!
+	 * @brief Get RMS mains voltage of the last half cycle
+	 * @return Returns voltage in volts
+	 */
+
+
+	float getRMSCurrent();
+	/*!
+	 * @brief Get RMS load current of the last half cycle
+	 * @return Returns current in amps
+	 */
+
+
+	float getRealPower();
+	/*!
+	 * @brief Get real power of the last half cycle
+	 * @return Returns power in watts
+	 */
+
+
+	float getEnergy();
+	/*!
+	 * @brief Get energy accumulated since begin or resetEnergy
+	 * @return Returns energy in watt hours
+	 */
+
+
+	void resetEnergy();
+	/*!
+	 * @brief Clear the energy accumulator
+	 * @return void
+	 */
+
+#endif
+
+
+#if (CVSLE_threePhaseMode == 1)
+
+	byte beginThreePhase(byte interruptPinA = CVSLE_interrupt, byte interruptPinB = CVSLE_interruptB, byte interruptPinC = CVSLE_interruptC, byte triacDriverPinA = CVSLE_triacDriver, byte triacDriverPinB = CVSLE_triacDriverB, byte triacDriverPinC = CVSLE_triacDriverC, byte loadRelayPin = CVSLE_loadRelay, bool inputPullupINT = true );
+	/*!
+	 * @brief Inits three phase operation. Phase A uses the normal zero-detect
+	 * path, phase B and C crossings are timestamped against it
+	 * @return Returns "1" for success and "0" for failure
+	 */
+
+
+	byte getPhaseStatus();
+	/*!
+	 * @brief Get result of phase sequence and spacing check
+	 * @return CVSLE_phaseOK, CVSLE_phaseMissing, CVSLE_phaseSequence or CVSLE_phaseSpacing
+	 */
+
+#endif
+
+
+	//****************************
+	//  Interrupt Function
+	//****************************
+#if (CVSLE_hookMode == 0)
+
+	void attachRoutineForCompare(void (*isr)()) __attribute__((always_inline)) {
+
+		isrCompare = isr;
+
+	}
+	/*!
+	 * @brief Attach Interrupt for when Compare ISR is triggered.
+	 * @return void
+	 */
+
+	void attachRoutineForOverflow(void (*isr)()) __attribute__((always_inline)) {
+
+		isrOverflow = isr;
+
+	}
+	/*!
+	 * @brief Attach Interrupt for when Overflow ISR is triggered.
+	 * @return void
+	 */
+
+	static void (*isrCompare)();
+	/*
+	 * @brief Stored custom function for compare ISR
+	 */
+
+	static void (*isrOverflow)();
+	/*
+	 * @brief Stored custom function for compare ISR
+	 */
+
+	static void isrDefaultUnused();
+	/*
+	 * @brief Default function for interrupts
+	 */
+
+#endif
+
+#if (CVSLE_powerQualityMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	void ZDOverflowRoutine();
+	/*
+	 * @brief Custom function for ZD timer overflow ISR
+	 */
+
+#endif
+
+#if (CVSLE_hookMode == 1)
+
+	//Hooks are inlined, so are the routines, no call from the ISR
+	inline void compareInterruptRoutine() __attribute__((always_inline));
+	/*
+	 * @brief Custom function for compareISR
+	 */
+
+	inline void overflowInterruptRoutine() __attribute__((always_inline));
+	/*
+	 * @brief Custom function for overflowISR
+	 */
+
+#else
+
+	void compareInterruptRoutine();
+	/*
+	 * @brief Custom function for compareISR
+	 */
+
+	void overflowInterruptRoutine();
+	/*
+	 * @brief Custom function for overflowISR
+	 */
+
+#endif
+
+	void zeroDetectISR();
+	/*
+	 * @brief CISR for zero detect
+	 */
+
+	void ZDTimerCalC();
+	/*
+	 * @brief Routine for ZD Time for calculation time period of input signal
+	 */
+
+#if (CVSLE_singleTimerMode == 1)
+
+	void compareBInterruptRoutine();
+	/*
+	 * @brief Custom function for compareB ISR, ends gate pulse
+	 */
+
+#endif
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	void zeroDetectCalISR();
+	/*
+	 * @brief ISR for the non zero-detect edge during calibration
+	 */
+
+#endif
+
+#if (CVSLE_adaptiveStartMode == 1) || (CVSLE_meteringMode == 1)
+
+	void adcInterruptRoutine();
+	/*
+	 * @brief Custom function for ADC conversion complete ISR
+	 */
+
+#endif
+
+#if (CVSLE_threePhaseMode == 1)
+
+	void zeroDetectPhaseISR(byte phase);
+	/*
+	 * @brief ISR for phase B (1) and phase C (2) zero detect
+	 */
+
+#endif
+
+private:
+
+	byte _interruptPin;
+	byte _triacDriverPin;
+	byte _softStartInterval;
+	byte _loadRelayPin;
+	byte _motorMax;
+	uint16_t volatile _ZDCounter;
+	byte _ZDTD;
+	bool _inputPullupINT;
+	unsigned long _currentLoadStart;
+	unsigned long _previousLoadStart;
+	byte _softStartIntervalCount;
+	boolean _absMotorFlag;
+
+
+	uint16_t volatile *  _timerCounter_P;
+	uint16_t volatile *  _outputCompare_P;
+	uint16_t volatile *  _inputCompare_P;
+	uint8_t volatile *  _timerMode_P;
+	uint8_t volatile *  _prescaler_P;
+	uint8_t volatile *  _interruptMask_P;
+	uint8_t volatile *  _interruptflag_P;
+
+
+	uint16_t volatile *  _timerCounter_ZD;
+	uint16_t volatile *  _outputCompare_ZD;
+	uint16_t volatile *  _inputCompare_ZD;
+	uint8_t volatile *  _timerMode_ZD;
+	uint8_t volatile *  _prescaler_ZD;
+	uint8_t volatile *  _interruptMask_ZD;
+	uint8_t volatile *  _interruptflag_ZD;
+
+
+	static void _ZDRoutine();
+	/*
+	 * @brief ZD Static wrapper
+	 */
+
+	uint16_t _ZDElapsed();
+	/*
+	 * @brief ZD counts since last zero-detect
+	 */
+
+
+#if (CVSLE_eventSystemMode == 1)
+
+	uint16_t _eventDelay;
+	unsigned long _eventCaptureAt; //millis() when a TCB2 capture was last seen
+
+
+	byte _eventSystemBegin();
+	/*
+	 * @brief Route zero-detect through the event system into TCB0..TCB2
+	 */
+
+	void _eventSystemApply();
+	/*
+	 * @brief Write firing delay and gate output enable to the TCBs when changed
+	 */
+
+	void _eventSystemPeriod();
+	/*
+	 * @brief Update ZD counter from the TCB2 period capture, zero when no
+	 * capture was seen for CVSLE_ZDTP
+	 */
+
+#endif
+
+
+	void _compareHook() __attribute__((always_inline));
+	/*
+	 * @brief Run user compare hook, inlined into the compare ISR
+	 */
+
+	void _overflowHook() __attribute__((always_inline));
+	/*
+	 * @brief Run user overflow hook, inlined into the overflow ISR
+	 */
+
+
+	uint16_t _firingDelay;
+	uint16_t volatile _setpoint[2];
+	byte volatile _setpointIndex;
+
+
+	void _publishFiringDelay();
+	/*
+	 * @brief Write _firingDelay to the idle setpoint buffer and flip the index,
+	 * the zero-detect ISR commits it at the start of the next half cycle
+	 */
+
+
+#if (CVSLE_singleTimerMode == 1)
+
+	uint16_t volatile *  _outputCompareB_P;
+	uint16_t volatile _ZDStamp;
+	uint16_t _ZDStampPrev;
+
+#endif
+
+
+#if (CVSLE_ZDCalibrationMode == 1)
+
+	byte volatile _ZDParity;
+	int _ZDOffset[2];
+	bool volatile _preRoll;
+	uint32_t volatile _calHigh[2];
+	uint32_t volatile _calPeriod[2];
+	byte volatile _calCount[2];
+	byte volatile _calPeriodCount[2];
+
+
+	static void _ZDCalRoutine();
+	/*
+	 * @brief ZD Static wrapper during calibration, attached on CHANGE
+	 */
+
+#endif
+
+
+#if (CVSLE_pulseTrainMode == 1)
+
+	byte _pulseCount;
+	byte _pulseWidth;
+	byte _pulseSpacing;
+	byte volatile _pulseIndex;
+	uint16_t volatile _pulseTime;
+
+#endif
+
+
+#if (CVSLE_adaptiveStartMode == 1)
+
+	uint16_t _currentLimit;
+	uint16_t volatile _currentPeak;
+	uint16_t volatile _currentPeakRun;
+	byte volatile _currentOver;
+	bool volatile _currentSampleReady;
+
+
+	void _adaptiveStep(long TCMin, long TCMax);
+	/*
+	 * @brief Advance or hold back firing delay based on last current peak
+	 */
+
+#endif
+
+
+#if (CVSLE_meteringMode == 1)
+
+	bool volatile _meterRunning;
+	bool volatile _meterVoltagePhase;
+	int volatile _meterVoltage;
+	int32_t volatile _sumV2;
+	int32_t volatile _sumI2;
+	int32_t volatile _sumVI;
+	uint16_t volatile _samples;
+	int32_t volatile _meterV2;
+	int32_t volatile _meterI2;
+	int32_t volatile _meterVI;
+	uint16_t volatile _meterN;
+	int64_t volatile _energyAcc;
+
+
+	void _meterSelect(byte channel);
+	/*
+	 * @brief Point ADC multiplexer at channel for the next conversion
+	 */
+
+#endif
+
+
+#if (CVSLE_scheduleMode == 1) || (CVSLE_timeBaseMode == 1)
+
+	uint32_t volatile _halfCycles; //Schedule clock, the time base when enabled
+
+#endif
+
+
+#if (CVSLE_scheduleMode == 1)
+
+	uint32_t _scheduleTime[CVSLE_scheduleSlots];
+	byte _scheduleAction[CVSLE_scheduleSlots];
+	byte _scheduleValue[CVSLE_scheduleSlots];
+	byte volatile _scheduleCount;
+	bool volatile _scheduleRun;
+
+
+	void _runSchedule();
+	/*
+	 * @brief Count half cycle and run due actions, called from ZD ISR
+	 */
+
+	void _applyLoadMax(byte motorMax);
+	/*
+	 * @brief Change load max and move firing delay to the same ramp point
+	 */
+
+#endif
+
+
+#if (CVSLE_thermalMode == 1)
+
+	uint32_t volatile _thermalConduction;
+	uint32_t volatile _thermalPeriod;
+	byte volatile _thermalCycles;
+	float _thermalRise;
+	float _thermalAmbient;
+	byte _thermalDerate;
+	uint16_t volatile _thermalFloor;
+
+#if (CVSLE_meteringMode == 1)
+
+	uint32_t volatile _thermalRunI; //|I| of the running half cycle in ADC counts
+	uint32_t volatile _thermalSumI; //|I| while the triac conducted, since the last step
+	uint32_t volatile _thermalSumI2; //I squared while the triac conducted, since the last step
+	uint32_t volatile _thermalSamples; //Current samples of all half cycles since the last step
+
+#endif
+
+
+	void _thermalStep();
+	/*
+	 * @brief Integrate counted conduction into junction temperature and set
+	 * the firing delay floor
+	 */
+
+#endif
+
+
+#if (CVSLE_loadIDMode == 1)
+
+	byte _loadType;
+	uint16_t _loadLag;
+	uint16_t volatile _loadMinTC;
+	byte volatile _gateWidth;
+	bool volatile _integralCycle;
+	byte volatile _cycleHalf;
+	bool volatile _cycleOn;
+	uint16_t volatile _cycleAcc;
+
+	bool volatile _idRun;
+	bool volatile _idSkip;
+	byte volatile _idHalfCycles;
+	byte _idCycles;
+	uint16_t volatile _idLagRun;
+	uint16_t volatile _idPeakRun;
+	uint32_t volatile _idSum;
+	uint16_t volatile _idCount;
+	uint32_t volatile _idLagSum;
+	uint32_t volatile _idPeakSum;
+	uint32_t volatile _idEarly;
+	uint32_t volatile _idLate;
+
+
+	void _loadIDSample(uint16_t current);
+	/*
+	 * @brief Fold one current sample into the running test, called from ADC ISR
+	 */
+
+	void _loadIDHalfCycle();
+	/*
+	 * @brief Close the half cycle of the running test, called from ZD ISR
+	 */
+
+	bool _loadIDTest(uint16_t delayTC, byte halfCycles);
+	/*
+	 * @brief Fire halfCycles at delayTC with the load relay ON, false on timeout
+	 */
+
+#endif
+
+
+#if (CVSLE_timeBaseMode == 1)
+
+	uint32_t volatile _timeResidual;
+	bool volatile _timeFallback;
+	bool volatile _timeLocked;
+
+
+	void _timeBaseUpdate(uint16_t counter);
+	/*
+	 * @brief Count a zero-crossing or fold crystal time into the time base
+	 */
+
+#endif
+
+	unsigned long _timeNow();
+	/*
+	 * @brief Ramp and timeout clock in CVSLETimeUnit counts
+	 */
+
+
+#if (CVSLE_bypassMode == 1)
+
+	byte volatile _bypassState;
+	byte volatile _bypassCount;
+	bool volatile _bypassStop; //stopLoad waiting for the contactor to open
+
+
+	void _bypassRequest();
+	/*
+	 * @brief Close the bypass at full load, open it below, from the main loop
+	 */
+
+	void _bypassZD();
+	/*
+	 * @brief Step contactor hand over at zero-cross, called from ZD ISR
+	 */
+
+	void _gateWrite(byte level);
+	/*
+	 * @brief Drive all triac driver pins
+	 */
+
+#endif
+
+	void _relayWrite(byte level);
+	/*
+	 * @brief Drive load relay, at the next contact zero-cross in relay sync mode
+	 */
+
+
+#if (CVSLE_relaySyncMode == 1)
+
+	byte volatile _relayLevel;
+	byte volatile _relayTarget;
+	bool volatile _relayPending;
+	bool volatile _relayArmed;
+	bool volatile _relayMeasuring;
+	bool volatile _relayFault;
+	uint16_t volatile _relayStamp;
+	uint16_t volatile _relayPeriods;
+	uint16_t volatile _relayDelay[2]; //Release, operate in ZD counts
+	uint16_t _relayRated[2];
+
+
+	void _relayZD(uint16_t counter);
+	/*
+	 * @brief Arm the coil command for this half cycle and time the contacts,
+	 * called from ZD ISR
+	 */
+
+	static void _relaySenseRoutine();
+	/*
+	 * @brief Auxiliary contact static wrapper, attached on CHANGE
+	 */
+
+#endif
+
+
+#if (CVSLE_powerQualityMode == 1)
+
+	bool _pqStarted;
+	uint16_t volatile _pqOverflows;
+	byte _pqWinN;
+	uint32_t _pqWinSum;
+	uint32_t _pqWinSq;
+	uint16_t _pqWinMin;
+	uint16_t _pqWinMax;
+	byte volatile _pqN;
+	uint32_t volatile _pqSum;
+	uint32_t volatile _pqSq;
+	uint16_t volatile _pqMin;
+	uint16_t volatile _pqMax;
+	byte volatile _pqNPrev;
+	uint32_t volatile _pqSumPrev;
+	uint16_t volatile _pqHistogram[CVSLE_pqBins];
+	uint16_t volatile _pqDropouts;
+	uint16_t volatile _pqGlitches;
+	uint32_t volatile _pqDropoutMax;
+
+
+	void _pqUpdate(uint16_t counter);
+	/*
+	 * @brief Fold one zero-cross period into statistics, O(1)
+	 */
+
+#endif
+
+
+#if (CVSLE_threePhaseMode == 1)
+
+	byte _interruptPinB;
+	byte _interruptPinC;
+	byte _triacDriverPinB;
+	byte _triacDriverPinC;
+	uint16_t volatile _ZDPhaseB;
+	uint16_t volatile _ZDPhaseC;
+	byte volatile _phaseSeen;
+	byte volatile _phaseStatus;
+	uint16_t _eventTime[CVSLE_gateEvents];
+	byte _eventPin[CVSLE_gateEvents];
+	byte _eventLevel[CVSLE_gateEvents];
+	byte volatile _eventCount;
+	byte volatile _eventIndex;
+
+
+	static void _ZDRoutineB();
+	/*
+	 * @brief ZD Static wrapper for phase B
+	 */
+
+	static void _ZDRoutineC();
+	/*
+	 * @brief ZD Static wrapper for phase C
+	 */
+
+	void _checkPhases();
+	/*
+	 * @brief Verify phase B/C crossings against phase A half cycle
+	 */
+
+	void _scheduleThreePhase();
+	/*
+	 * @brief Build the gate pulse schedule for all three phases
+	 */
+
+	void _addEvent(uint16_t time, byte pin, byte level);
+	/*
+	 * @brief Insert a gate event into the schedule sorted by time
+	 */
+
+#endif
+
 
 };//EOP class
 
@@ -0,0 +1,45 @@
+/*
+ * CVSLEHooks.h
+ *
+ *
+ * Compile time user hooks for CVSLE, used when CVSLE_hookMode is 1 in CVSLE.h.
+ * The bodies below are compiled straight into the process timer compare and
+ * overflow ISRs, so an empty hook costs nothing and a short one is inlined
+ * without the register save an indirect call needs.
+ *
+ * Edit the bodies in place. Code here runs in interrupt context every half
+ * cycle, keep it short and touch only volatile data. attachRoutineForCompare
+ * and attachRoutineForOverflow are not available in this mode.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLEHOOKS_H_
+#define CVSLEHOOKS_H_
+
+#include "CVSLE.h"
+
+
+//Called from compare ISR, gate pulse start
+static inline void __attribute__((always_inline)) CVSLE_compareHook(){
+
+
+}//EOP CVSLE_compareHook
+
+
+//Called from overflow ISR, gate pulse end
+static inline void __attribute__((always_inline)) CVSLE_overflowHook(){
+
+
+}//EOP CVSLE_overflowHook
+
+
+#endif /* CVSLEHOOKS_H_ */
@@ -0,0 +1,817 @@
+/*
+ * CVSLEModbus.cpp
+ *
+ *
+ * Modbus RTU slave for CVSLE. Exposes load max, soft start interval,
+ * start/stop, input frequency and load state as holding registers over
+ * a RS-485 line.
+ *
+ * WORKS ONLY IN AVR Architecture boards. Drives the selected USART directly
+ * through its interrupts, so the matching Arduino SerialN object must not be
+ * used in the same sketch.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include "CVSLEModbus.h"
+
+#if (CVSLE_modbusMode == 1)
+
+
+//CVSLEModbus Object
+CVSLEModbus cvsModbus;
+
+
+//Begin function
+byte CVSLEModbus::begin(byte slaveID, unsigned long baud, byte dePin){
+
+	//Variables
+	byte result=0;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Init all variables
+	 * 2) Init USART register pointers based on selected USART
+	 * 3) Setup USART for 8N1 with receive interrupt
+	 * 4) Setup driver enable pin
+	 *
+	 */
+
+
+	//Step 1 => init all variables
+	_slaveID=slaveID;
+	_dePin=dePin;
+	_runRequest=false;
+	_runActive=false;
+	_frameCount=0;
+	_errorCount=0;
+	_rxHead=0;
+	_rxTail=0;
+	_lastRx=0;
+
+	for(byte i=0;i<(CVSLE_modbusRxBuffer/8);i++){
+
+		_rxStart[i]=0;
+
+	}//EOP clear frame starts
+
+	_frameLength=0;
+	_frameOverrun=false;
+	_crc=0xFFFF;
+	_txLength=0;
+	_txIndex=0;
+	_transmitting=false;
+
+	//3.5 character silence ends a frame, fixed 1750us above 19200 baud
+	if(baud>19200){
+
+		_frameGap=1750;
+
+	}//EOP fixed gap
+	else{
+
+		_frameGap=(11UL*1000000UL*7)/(baud*2);
+
+	}//EOP gap from baud
+
+
+	//Step 2 => USART init
+#if (CVSLE_modbusUSART == 0)
+
+	_data_M=&UDR0;
+	_statusA_M=&UCSR0A;
+	_control_M=&UCSR0B;
+	_frameFormat_M=&UCSR0C;
+	_baud_M=&UBRR0;
+
+	result=1;
+
+
+#elif (CVSLE_modbusUSART == 1) && defined(UDR1)
+
+	_data_M=&UDR1;
+	_statusA_M=&UCSR1A;
+	_control_M=&UCSR1B;
+	_frameFormat_M=&UCSR1C;
+	_baud_M=&UBRR1;
+
+	result=1;
+
+
+#elif (CVSLE_modbusUSART == 2) && defined(UDR2)
+
+	_data_M=&UDR2;
+	_statusA_M=&UCSR2A;
+	_control_M=&UCSR2B;
+	_frameFormat_M=&UCSR2C;
+	_baud_M=&UBRR2;
+
+	result=1;
+
+
+#elif (CVSLE_modbusUSART == 3) && defined(UDR3)
+
+	_data_M=&UDR3;
+	_statusA_M=&UCSR3A;
+	_control_M=&UCSR3B;
+	_frameFormat_M=&UCSR3C;
+	_baud_M=&UBRR3;
+
+	result=1;
+
+
+#else
+	result=0;
+
+
+#endif
+
+	//Check result
+	if(result!=0){
+
+		//Step 3 => Setup USART
+		noInterrupts();
+
+		*_control_M=0;
+		*_statusA_M=(1 << U2X0);   // double speed
+		*_baud_M=(F_CPU/(8UL*baud))-1;
+		*_frameFormat_M=(1 << UCSZ01) | (1 << UCSZ00);   // 8N1
+		*_control_M=(1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);   // enable receive interrupt
+
+		interrupts();
+
+		//Step 4 => Driver enable pin, receive by default
+		pinMode(_dePin,OUTPUT);
+		digitalWrite(_dePin,LOW);
+
+	}//EOP result OK
+
+	//Return statement
+	return result;
+
+}//EOP begin function
+
+
+//poll
+void CVSLEModbus::poll(){
+
+	//Variables
+	byte count=0;
+	unsigned long lastRx=0;
+
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Move a bounded number of received bytes into the frame, ending
+	 *    the frame at a gap marked by the receive ISR
+	 * 2) Process frame once the bus has been silent for 3.5 characters
+	 * 3) Apply run register
+	 *
+	 */
+
+
+	//Step 1 => Move received bytes
+	while( (_rxHead!=_rxTail) && (count<CVSLE_modbusBytesPerPoll) ){
+
+		byte data=_rxBuffer[_rxTail];
+
+		//Byte opens a new frame, the one collected so far is complete
+		if( (_rxStart[_rxTail>>3] & (1 << (_rxTail & 7))) && (_frameLength>0) ){
+
+			_endFrame();
+
+		}//EOP frame boundary
+
+		_rxTail=(_rxTail+1) & (CVSLE_modbusRxBuffer-1);
+
+		//Check frame length
+		if(_frameLength<CVSLE_modbusFrameMax){
+
+			_frame[_frameLength]=data;
+			_frameLength++;
+
+			_crc=_crc16(_crc, data);
+
+		}//EOP frame space left
+		else{
+
+			_frameOverrun=true;
+
+		}//EOP frame too long
+
+		count++;
+
+	}//EOP received bytes
+
+	//Step 2 => Check end of frame
+	noInterrupts();
+	lastRx=_lastRx;
+	interrupts();
+
+	if( (_frameLength>0) && (_rxHead==_rxTail) && ((micros()-lastRx)>_frameGap) ){
+
+		_endFrame();
+
+	}//EOP end of frame
+
+	//Step 3 => Apply run register
+	if(_runRequest){
+
+		//Soft start polling
+		cvsLE.startLoadSoft();
+
+		_runActive=true;
+
+	}//EOP run requested
+	else if(_runActive){
+
+		cvsLE.stopLoad();
+
+		_runActive=false;
+
+	}//EOP stop requested
+
+
+}//EOP poll
+
+
+//End frame
+void CVSLEModbus::_endFrame(){
+
+	//Check frame
+	if(_frameOverrun || (_frameLength<4) || (_crc!=0) ){
+
+		_errorCount++;
+
+	}//EOP bad frame
+	else if(!_transmitting){
+
+		_processFrame();
+
+	}//EOP good frame
+
+	//Reset for next frame
+	_frameLength=0;
+	_frameOverrun=false;
+	_crc=0xFFFF;
+
+}//EOP _endFrame
+
+
+//getRunRequest
+bool CVSLEModbus::getRunRequest(){
+
+	//Variables
+	bool result=false;
+
+	result=_runRequest;
+
+	//Return
+	return result;
+
+}//EOP getRunRequest
+
+
+//getFrameCount
+uint16_t CVSLEModbus::getFrameCount(){
+
+	//Variables
+	uint16_t result=0;
+
+	result=_frameCount;
+
+	//Return
+	return result;
+
+}//EOP getFrameCount
+
+
+//getErrorCount
+uint16_t CVSLEModbus::getErrorCount(){
+
+	//Variables
+	uint16_t result=0;
+
+	result=_errorCount;
+
+	//Return
+	return result;
+
+}//EOP getErrorCount
+
+
+//Process frame
+void CVSLEModbus::_processFrame(){
+
+	//Variables
+	byte address=_frame[0];
+	byte function=_frame[1];
+	uint16_t start=0;
+	uint16_t quantity=0;
+	uint16_t value=0;
+	byte code=0;
+	byte i=0;
+
+	//Check slave address, 0 is broadcast
+	if( (address!=_slaveID) && (address!=0) ){
+
+		return;
+
+	}//EOP not for this slave
+
+	_frameCount++;
+
+	//Register address and quantity or value
+	start=((uint16_t)_frame[2] << 8) | _frame[3];
+	quantity=((uint16_t)_frame[4] << 8) | _frame[5];
+
+	//Check function
+	if( (function==0x03) || (function==0x04) ){
+
+		//Read holding/input registers
+		if( (_frameLength!=8) || (quantity<1) || (quantity>CVSLE_modbusRegCount) ){
+
+			code=CVSLE_modbusIllegalValue;
+
+		}//EOP bad quantity
+		else if( (start+quantity)>CVSLE_modbusRegCount ){
+
+			code=CVSLE_modbusIllegalAddress;
+
+		}//EOP bad address
+		else if(address!=0){
+
+			_txBuffer[0]=_slaveID;
+			_txBuffer[1]=function;
+			_txBuffer[2]=quantity*2;
+
+			for(i=0;i<quantity;i++){
+
+				_readRegister(start+i, &value);
+
+				_txBuffer[3+(i*2)]=value >> 8;
+				_txBuffer[4+(i*2)]=value & 0xFF;
+
+			}//EOP registers
+
+			_txLength=3+(quantity*2);
+
+			_send();
+
+		}//EOP response
+
+	}//EOP read
+	else if(function==0x06){
+
+		//Write single register
+		if(_frameLength!=8){
+
+			code=CVSLE_modbusIllegalValue;
+
+		}//EOP bad length
+		else{
+
+			code=_writeRegister(start, quantity);
+
+			//Echo request
+			if( (code==0) && (address!=0) ){
+
+				for(i=0;i<6;i++){
+
+					_txBuffer[i]=_frame[i];
+
+				}//EOP echo
+
+				_txLength=6;
+
+				_send();
+
+			}//EOP response
+
+		}//EOP length OK
+
+	}//EOP write single
+	else if(function==0x10){
+
+		//Write multiple registers
+		if( (quantity<1) || (quantity>CVSLE_modbusRegCount) || (_frame[6]!=(quantity*2)) || (_frameLength!=(9+(quantity*2))) ){
+
+			code=CVSLE_modbusIllegalValue;
+
+		}//EOP bad quantity
+		else if( (start+quantity)>CVSLE_modbusRegCount ){
+
+			code=CVSLE_modbusIllegalAddress;
+
+		}//EOP bad address
+		else{
+
+			for(i=0;(i<quantity) && (code==0);i++){
+
+				value=((uint16_t)_frame[7+(i*2)] << 8) | _frame[8+(i*2)];
+
+				code=_writeRegister(start+i, value);
+
+			}//EOP registers
+
+			//Echo address and quantity
+			if( (code==0) && (address!=0) ){
+
+				for(i=0;i<6;i++){
+
+					_txBuffer[i]=_frame[i];
+
+				}//EOP echo
+
+				_txLength=6;
+
+				_send();
+
+			}//EOP response
+
+		}//EOP quantity OK
+
+	}//EOP write multiple
+	else{
+
+		code=CVSLE_modbusIllegalFunction;
+
+	}//EOP unsupported function
+
+	//Check exception, no response to broadcast
+	if( (code!=0) && (address!=0) ){
+
+		_sendException(function, code);
+
+	}//EOP exception
+
+
+}//EOP _processFrame
+
+
+//Read register
+bool CVSLEModbus::_readRegister(uint16_t address, uint16_t *value){
+
+	//Variables
+	bool result=true;
+	float frequency=0;
+
+	//Check address
+	switch(address){
+
+		case CVSLE_modbusRegLoadMax:
+			*value=cvsLE.getLoadMax();
+			break;
+
+		case CVSLE_modbusRegSoftStart:
+			*value=cvsLE.getSoftStartInterval();
+			break;
+
+		case CVSLE_modbusRegRun:
+			*value=_runRequest?1:0;
+			break;
+
+		case CVSLE_modbusRegFrequency:
+			frequency=cvsLE.getInputFrequency();
+			*value=(frequency>0)?(uint16_t)(frequency*100.0):0;
+			break;
+
+		case CVSLE_modbusRegState:
+			*value=(cvsLE.motorStatus?1:0) | (cvsLE.motorMaxFlag?2:0);
+			break;
+
+		default:
+			result=false;
+			break;
+
+	}//EOP address
+
+	//Return
+	return result;
+
+}//EOP _readRegister
+
+
+//Write register
+byte CVSLEModbus::_writeRegister(uint16_t address, uint16_t value){
+
+	//Variables
+	byte result=0;
+
+	//Check address
+	switch(address){
+
+		case CVSLE_modbusRegLoadMax:
+			if(value>255){
+				result=CVSLE_modbusIllegalValue;
+			}
+			else if(cvsLE.motorStatus){
+				result=CVSLE_modbusSlaveFailure;
+			}
+			else{
+				cvsLE.setLoadMax(value);
+			}
+			break;
+
+		case CVSLE_modbusRegSoftStart:
+			if(value>255){
+				result=CVSLE_modbusIllegalValue;
+			}
+			else if(cvsLE.motorStatus){
+				result=CVSLE_modbusSlaveFailure;
+			}
+			else{
+				cvsLE.setSoftStartInterval(value);
+			}
+			break;
+
+		case CVSLE_modbusRegRun:
+			if(value>1){
+				result=CVSLE_modbusIllegalValue;
+			}
+			else{
+				_runRequest=(value==1);
+			}
+			break;
+
+		case CVSLE_modbusRegFrequency:
+		case CVSLE_modbusRegState:
+			result=CVSLE_modbusIllegalAddress;
+			break;
+
+		default:
+			result=CVSLE_modbusIllegalAddress;
+			break;
+
+	}//EOP address
+
+	//Return
+	return result;
+
+}//EOP _writeRegister
+
+
+//Send exception
+void CVSLEModbus::_sendException(byte function, byte code){
+
+	_txBuffer[0]=_slaveID;
+	_txBuffer[1]=function | 0x80;
+	_txBuffer[2]=code;
+	_txLength=3;
+
+	_send();
+
+}//EOP _sendException
+
+
+//Send response
+void CVSLEModbus::_send(){
+
+	//Variables
+	uint16_t crc=0xFFFF;
+	byte i=0;
+
+	//Append CRC, low byte first
+	for(i=0;i<_txLength;i++){
+
+		crc=_crc16(crc, _txBuffer[i]);
+
+	}//EOP crc
+
+	_txBuffer[_txLength]=crc & 0xFF;
+	_txBuffer[_txLength+1]=crc >> 8;
+	_txLength=_txLength+2;
+	_txIndex=0;
+	_transmitting=true;
+
+	//Enable driver and data register empty interrupt
+	digitalWrite(_dePin,HIGH);
+	*_control_M |= (1 << UDRIE0);
+
+
+}//EOP _send
+
+
+//CRC16
+uint16_t CVSLEModbus::_crc16(uint16_t crc, byte data){
+
+	//Variables
+	byte i=0;
+
+	crc^=data;
+
+	for(i=0;i<8;i++){
+
+		if(crc & 0x0001){
+
+			crc=(crc >> 1) ^ 0xA001;
+
+		}//EOP lsb set
+		else{
+
+			crc=crc >> 1;
+
+		}//EOP lsb clear
+
+	}//EOP bits
+
+	//Return
+	return crc;
+
+}//EOP _crc16
+
+
+
+//****************************
+//  Interrupt Function
+//****************************
+
+#if (CVSLE_modbusUSART == 0)
+
+#if defined(USART0_RX_vect)
+ISR(USART0_RX_vect){
+#else
+ISR(USART_RX_vect){
+#endif
+
+	cvsModbus.rxInterruptRoutine();
+
+}//EOP receive ISR
+
+
+#if defined(USART0_UDRE_vect)
+ISR(USART0_UDRE_vect){
+#else
+ISR(USART_UDRE_vect){
+#endif
+
+	cvsModbus.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+#if defined(USART0_TX_vect)
+ISR(USART0_TX_vect){
+#else
+ISR(USART_TX_vect){
+#endif
+
+	cvsModbus.txcInterruptRoutine();
+
+}//EOP transmit complete ISR
+
+
+#elif (CVSLE_modbusUSART == 1) && defined(UDR1)
+
+ISR(USART1_RX_vect){
+
+	cvsModbus.rxInterruptRoutine();
+
+}//EOP receive ISR
+
+
+ISR(USART1_UDRE_vect){
+
+	cvsModbus.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+ISR(USART1_TX_vect){
+
+	cvsModbus.txcInterruptRoutine();
+
+}//EOP transmit complete ISR
+
+
+#elif (CVSLE_modbusUSART == 2) && defined(UDR2)
+
+ISR(USART2_RX_vect){
+
+	cvsModbus.rxInterruptRoutine();
+
+}//EOP receive ISR
+
+
+ISR(USART2_UDRE_vect){
+
+	cvsModbus.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+ISR(USART2_TX_vect){
+
+	cvsModbus.txcInterruptRoutine();
+
+}//EOP transmit complete ISR
+
+
+#elif (CVSLE_modbusUSART == 3) && defined(UDR3)
+
+ISR(USART3_RX_vect){
+
+	cvsModbus.rxInterruptRoutine();
+
+}//EOP receive ISR
+
+
+ISR(USART3_UDRE_vect){
+
+	cvsModbus.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+ISR(USART3_TX_vect){
+
+	cvsModbus.txcInterruptRoutine();
+
+}//EOP transmit complete ISR
+
+
+#endif
+
+
+//rxInterruptRoutine
+void CVSLEModbus::rxInterruptRoutine()
+{
+
+	//Variables
+	byte data=*_data_M;
+	byte next=(_rxHead+1) & (CVSLE_modbusRxBuffer-1);
+	unsigned long now=micros();
+
+	//Ignore own echo while transmitting and bytes on a full buffer
+	if( (!_transmitting) && (next!=_rxTail) ){
+
+		_rxBuffer[_rxHead]=data;
+
+		//Mark 3.5 character gap here, poll may run long after it
+		if((now-_lastRx)>_frameGap){
+
+			_rxStart[_rxHead>>3]|=(1 << (_rxHead & 7));
+
+		}//EOP frame start
+		else{
+
+			_rxStart[_rxHead>>3]&=~(1 << (_rxHead & 7));
+
+		}//EOP same frame
+
+		_rxHead=next;
+
+	}//EOP store
+
+	//Timestamp for frame gap
+	_lastRx=now;
+
+
+}//EOP rxInterruptRoutine
+
+
+//udreInterruptRoutine
+void CVSLEModbus::udreInterruptRoutine()
+{
+
+	//Send next byte
+	*_data_M=_txBuffer[_txIndex];
+	_txIndex++;
+
+	//Check last byte
+	if(_txIndex>=_txLength){
+
+		//Wait for last byte to leave shift register
+		*_statusA_M=(*_statusA_M & (1 << U2X0)) | (1 << TXC0);
+		*_control_M=(*_control_M & ~(1 << UDRIE0)) | (1 << TXCIE0);
+
+	}//EOP last byte
+
+
+}//EOP udreInterruptRoutine
+
+
+//txcInterruptRoutine
+void CVSLEModbus::txcInterruptRoutine()
+{
+
+	//Release bus
+	digitalWrite(_dePin,LOW);
+
+	*_control_M &= ~(1 << TXCIE0);
+
+	_transmitting=false;
+
+
+}//EOP txcInterruptRoutine
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * CVSLEModbus.h
+ *
+ *
+ * Modbus RTU slave for CVSLE. Exposes load max, soft start interval,
+ * start/stop, input frequency and load state as holding registers over
+ * a RS-485 line.
+ *
+ * WORKS ONLY IN AVR Architecture boards. Drives the selected USART directly
+ * through its interrupts, so the matching Arduino SerialN object must not be
+ * used in the same sketch.
+ *
+ * Reception and transmission are interrupt driven and ring buffered. poll()
+ * moves at most CVSLE_modbusBytesPerPoll bytes per call and handles at most
+ * one frame, so it can be called from loop() next to startLoadSoft() without
+ * disturbing ramp or gate timing.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLEMODBUS_H_
+#define CVSLEMODBUS_H_
+
+#include <Arduino.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "CVSLE.h"
+
+#define CVSLE_modbusMode 0 //Modbus RTU slave enabled (1) or not (0)
+#define CVSLE_modbusUSART 1 //USART used for the bus
+#define CVSLE_modbusSlaveID 1 //Default slave address
+#define CVSLE_modbusBaud 19200 //Default baud rate
+#define CVSLE_modbusDEPin 4 //RS-485 driver enable pin
+#define CVSLE_modbusRxBuffer 64 //Receive ring buffer size, power of 2 from 8
+#define CVSLE_modbusFrameMax 32 //Max request frame length
+#define CVSLE_modbusTxBuffer 32 //Max response frame length
+#define CVSLE_modbusBytesPerPoll 8 //Max bytes parsed per poll call
+
+//Holding registers
+#define CVSLE_modbusRegLoadMax 0 //Load max % (R/W, write only while stopped)
+#define CVSLE_modbusRegSoftStart 1 //Soft start interval in seconds (R/W, write only while stopped)
+#define CVSLE_modbusRegRun 2 //1 runs soft start, 0 stops load (R/W)
+#define CVSLE_modbusRegFrequency 3 //Input frequency in 0.01 Hz, 0 on error (R)
+#define CVSLE_modbusRegState 4 //Bit 0 motorStatus, bit 1 motorMaxFlag (R)
+#define CVSLE_modbusRegCount 5 //Number of holding registers
+
+//Exception codes
+#define CVSLE_modbusIllegalFunction 1
+#define CVSLE_modbusIllegalAddress 2
+#define CVSLE_modbusIllegalValue 3
+#define CVSLE_modbusSlaveFailure 4
+
+
+#if (CVSLE_modbusMode == 1)
+
+class CVSLEModbus {
+
+
+public:
+
+	byte begin(byte slaveID = CVSLE_modbusSlaveID, unsigned long baud = CVSLE_modbusBaud, byte dePin = CVSLE_modbusDEPin);
+	/*!
+	 * @brief Inits the USART, driver enable pin and buffers
+	 * @return Returns "1" for success and "0" for failure
+	 */
+
+
+	void poll();
+	/*!
+	 * @brief Parse received bytes, answer a complete frame and apply the
+	 * run register. Call from loop() as often as possible
+	 * @return void
+	 */
+
+
+	bool getRunRequest();
+	/*!
+	 * @brief Get the value last written to the run register
+	 * @return Returns true when a run is requested
+	 */
+
+
+	uint16_t getFrameCount();
+	/*!
+	 * @brief Get number of valid frames addressed to this slave
+	 * @return Frame count
+	 */
+
+
+	uint16_t getErrorCount();
+	/*!
+	 * @brief Get number of frames dropped for CRC or length errors
+	 * @return Error count
+	 */
+
+
+	void rxInterruptRoutine();
+	/*
+	 * @brief Custom function for USART receive ISR
+	 */
+
+	void udreInterruptRoutine();
+	/*
+	 * @brief Custom function for USART data register empty ISR
+	 */
+
+	void txcInterruptRoutine();
+	/*
+	 * @brief Custom function for USART transmit complete ISR
+	 */
+
+private:
+
+	byte _slaveID;
+	byte _dePin;
+	unsigned long _frameGap;
+	bool _runRequest;
+	bool _runActive;
+	uint16_t _frameCount;
+	uint16_t _errorCount;
+
+	byte volatile _rxBuffer[CVSLE_modbusRxBuffer];
+	byte volatile _rxHead;
+	byte _rxTail;
+	unsigned long volatile _lastRx;
+	byte volatile _rxStart[CVSLE_modbusRxBuffer/8]; //Bit per buffer slot, set on the first byte after a 3.5 character gap
+
+	byte _frame[CVSLE_modbusFrameMax];
+	byte _frameLength;
+	bool _frameOverrun;
+	uint16_t _crc;
+
+	byte _txBuffer[CVSLE_modbusTxBuffer];
+	byte volatile _txLength;
+	byte volatile _txIndex;
+	bool volatile _transmitting;
+
+
+	uint8_t volatile *  _data_M;
+	uint8_t volatile *  _statusA_M;
+	uint8_t volatile *  _control_M;
+	uint8_t volatile *  _frameFormat_M;
+	uint16_t volatile *  _baud_M;
+
+
+	static uint16_t _crc16(uint16_t crc, byte data);
+	/*
+	 * @brief Update Modbus CRC with one byte
+	 */
+
+	void _endFrame();
+	/*
+	 * @brief Check CRC and length of _frame, execute it and reset for the next frame
+	 */
+
+	void _processFrame();
+	/*
+	 * @brief Validate and execute the frame in _frame
+	 */
+
+	bool _readRegister(uint16_t address, uint16_t *value);
+	/*
+	 * @brief Read one holding register, false for illegal address
+	 */
+
+	byte _writeRegister(uint16_t address, uint16_t value);
+	/*
+	 * @brief Write one holding register, returns exception code or 0
+	 */
+
+	void _sendException(byte function, byte code);
+	/*
+	 * @brief Send exception response
+	 */
+
+	void _send();
+	/*
+	 * @brief Append CRC to _txBuffer and start transmission
+	 */
+
+
+};//EOP class
+
+
+extern CVSLEModbus cvsModbus;
+
+#endif
+
+#endif /* CVSLEMODBUS_H_ */
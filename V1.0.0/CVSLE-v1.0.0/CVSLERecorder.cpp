@@ -0,0 +1,250 @@
+/*
+ * CVSLERecorder.cpp
+ *
+ *
+ * Post-mortem flight recorder for CVSLE. The zero-detect ISR logs the last
+ * CVSLE_recorderDepth half cycles into a ring kept in the .noinit section, so
+ * the log survives a watchdog or external reset.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include "CVSLERecorder.h"
+
+#if (CVSLE_recorderMode == 1)
+
+
+//CVSLERecorder Object, not cleared by the C runtime at reset
+CVSLERecorder cvsRecorder __attribute__((section(".noinit")));
+
+
+//Begin function
+byte CVSLERecorder::begin(){
+
+	//Variables
+	byte result=0;
+	bool valid=( (_magic==CVSLE_recorderMagic) && (_head<CVSLE_recorderDepth) && (_count<=CVSLE_recorderDepth) && (_reason<=CVSLE_freezeUser) );
+
+#if defined(WDRF)
+
+	//Reset flags stay set until written, clear them so the next reset is told apart
+	byte resetFlags=MCUSR;
+	MCUSR=0;
+
+#endif
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Check block left in RAM by the last run
+	 * 2) Freeze it when the reset hit while recording
+	 * 3) Start a fresh ring when nothing is held
+	 *
+	 */
+
+
+	//Step 1 => Check block
+	if(valid && (_count>0)){
+
+		//Step 2 => Reset while recording
+		if(_reason==CVSLE_freezeNone){
+
+#if defined(WDRF)
+			_reason=(resetFlags & (1 << WDRF)) ? CVSLE_freezeWatchdog : CVSLE_freezeReset;
+#else
+			_reason=CVSLE_freezeReset;
+#endif
+
+		}//EOP was recording
+
+		result=1;
+
+	}//EOP held recording
+	else{
+
+		//Step 3 => Fresh ring
+		rearm();
+
+	}//EOP nothing held
+
+
+	//Return statement
+	return result;
+
+}//EOP begin
+
+
+//Push record
+void CVSLERecorder::push(uint16_t period, uint16_t compare, byte state, byte fault, uint16_t isrTime){
+
+	//Check frozen
+	if(_reason!=CVSLE_freezeNone){
+
+		return;
+
+	}//EOP frozen
+
+	//Store at head
+	CVSLERecord *record=&_records[_head];
+
+	record->period=period;
+	record->compare=compare;
+	record->state=state;
+	record->fault=fault;
+	record->isrTime=isrTime;
+
+	_head=(_head+1) & (CVSLE_recorderDepth-1);
+
+	if(_count<CVSLE_recorderDepth){
+
+		_count++;
+
+	}//EOP ring not full
+
+	//Freeze on first fault, faulted half cycle is the newest record
+	if(fault!=0){
+
+		_reason=CVSLE_freezeFault;
+
+	}//EOP fault
+
+
+}//EOP push
+
+
+//Freeze
+void CVSLERecorder::freeze(byte reason){
+
+	//Variables, stopLoad may call this from the ZD ISR
+	uint8_t oldSREG=SREG;
+
+	noInterrupts();
+
+	//First reason wins
+	if(_reason==CVSLE_freezeNone){
+
+		_reason=reason;
+
+	}//EOP recording
+
+	SREG=oldSREG;
+
+}//EOP freeze
+
+
+//Rearm
+void CVSLERecorder::rearm(){
+
+	noInterrupts();
+
+	_head=0;
+	_count=0;
+	_reason=CVSLE_freezeNone;
+	_magic=CVSLE_recorderMagic;
+
+	interrupts();
+
+}//EOP rearm
+
+
+//get reason
+byte CVSLERecorder::getReason(){
+
+	//Variables
+	byte result=0;
+
+	result=_reason;
+
+	//Return
+	return result;
+
+}//EOP getReason
+
+
+//get count
+byte CVSLERecorder::getCount(){
+
+	//Variables
+	byte result=0;
+
+	result=_count;
+
+	//Return
+	return result;
+
+}//EOP getCount
+
+
+//get record
+bool CVSLERecorder::getRecord(byte index, CVSLERecord *record){
+
+	//Variables
+	bool result=false;
+
+	noInterrupts();
+
+	//Check index
+	if(index<_count){
+
+		//Oldest record sits count places behind head
+		byte slot=(_head+CVSLE_recorderDepth-_count+index) & (CVSLE_recorderDepth-1);
+
+		*record=_records[slot];
+
+		result=true;
+
+	}//EOP valid index
+
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getRecord
+
+
+//Dump
+void CVSLERecorder::dump(Print &out){
+
+	//Variables
+	CVSLERecord record;
+	byte count=getCount();
+
+	out.print("reason,");
+	out.println(getReason());
+	out.println("index,period,compare,state,fault,isrTime");
+
+	for(byte i=0;i<count;i++){
+
+		//Check record
+		if(!getRecord(i, &record)){
+
+			break;
+
+		}//EOP ring changed
+
+		out.print(i);
+		out.print(',');
+		out.print(record.period);
+		out.print(',');
+		out.print(record.compare);
+		out.print(',');
+		out.print(record.state);
+		out.print(',');
+		out.print(record.fault);
+		out.print(',');
+		out.println(record.isrTime);
+
+	}//EOP records
+
+}//EOP dump
+
+#endif
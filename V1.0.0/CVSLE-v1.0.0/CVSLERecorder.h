@@ -0,0 +1,139 @@
+/*
+ * CVSLERecorder.h
+ *
+ *
+ * Post-mortem flight recorder for CVSLE. The zero-detect ISR logs the last
+ * CVSLE_recorderDepth half cycles into a ring kept in the .noinit section, so
+ * the log survives a watchdog or external reset.
+ *
+ * The ring freezes on the first record with fault bits set, on stopLoad()
+ * while the load is running, or at begin after a reset while it was still
+ * recording. A frozen ring is kept until rearm(). begin clears MCUSR after
+ * reading it, read MCUSR before cvsLE.begin if the sketch needs the reset
+ * cause too. On boards whose bootloader clears MCUSR first, watchdog resets
+ * are reported as CVSLE_freezeReset, the bootloader then has to leave
+ * MCUSR for the sketch to clear.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLERECORDER_H_
+#define CVSLERECORDER_H_
+
+#include <Arduino.h>
+
+#include <avr/io.h>
+
+#define CVSLE_recorderMode 0 //Post-mortem flight recorder (1) or not (0)
+#define CVSLE_recorderDepth 32 //Half cycles kept, power of 2, max 128
+#define CVSLE_recorderMagic 0x5A17 //Marks a valid recorder block in .noinit RAM
+
+//Freeze reasons
+#define CVSLE_freezeNone 0 //Recording
+#define CVSLE_freezeFault 1 //Record with fault bits set
+#define CVSLE_freezeStop 2 //stopLoad on a running load
+#define CVSLE_freezeWatchdog 3 //Watchdog reset while recording
+#define CVSLE_freezeReset 4 //Other reset while recording
+#define CVSLE_freezeUser 5 //freeze called by sketch
+
+
+#if (CVSLE_recorderMode == 1)
+
+struct CVSLERecord {
+
+	uint16_t period; //ZD counts
+	uint16_t compare; //Firing delay in PT counts
+	byte state; //CVSLE_state* bits
+	byte fault; //CVSLE_fault* bits
+	uint16_t isrTime; //ZD ISR run time in microSecs
+
+};//EOP struct
+
+
+class CVSLERecorder {
+
+
+public:
+
+	byte begin();
+	/*!
+	 * @brief Check the block kept across reset, freeze it if the reset hit
+	 * while recording, else start a fresh ring. Called by cvsLE.begin
+	 * @return Returns "1" when a frozen recording is held and "0" otherwise
+	 */
+
+
+	void push(uint16_t period, uint16_t compare, byte state, byte fault, uint16_t isrTime);
+	/*!
+	 * @brief Log one half cycle. Call from ISR context only
+	 * @return void
+	 */
+
+
+	void freeze(byte reason = CVSLE_freezeUser);
+	/*!
+	 * @brief Stop logging and keep the ring, first reason wins
+	 * @return void
+	 */
+
+
+	void rearm();
+	/*!
+	 * @brief Clear the ring and resume logging
+	 * @return void
+	 */
+
+
+	byte getReason();
+	/*!
+	 * @brief Get why the ring froze
+	 * @return CVSLE_freeze* reason, CVSLE_freezeNone while recording
+	 */
+
+
+	byte getCount();
+	/*!
+	 * @brief Get number of records held
+	 * @return Record count
+	 */
+
+
+	bool getRecord(byte index, CVSLERecord *record);
+	/*!
+	 * @brief Copy one record, index 0 is the oldest
+	 * @return Returns true for a valid index
+	 */
+
+
+	void dump(Print &out);
+	/*!
+	 * @brief Print reason and all records as CSV, oldest first. Call on a
+	 * frozen ring for a consistent dump
+	 * @return void
+	 */
+
+private:
+
+	uint16_t _magic;
+	byte volatile _head;
+	byte volatile _count;
+	byte volatile _reason;
+	CVSLERecord _records[CVSLE_recorderDepth];
+
+
+};//EOP class
+
+
+extern CVSLERecorder cvsRecorder;
+
+#endif
+
+#endif /* CVSLERECORDER_H_ */
@@ -0,0 +1,524 @@
+/*
+ * CVSLEStagger.cpp
+ *
+ *
+ * Staggered start coordination for CVSLE units sharing one RS-485 line.
+ * Units negotiate start slots with randomised backoff so that no more than
+ * CVSLE_staggerConcurrent soft starts ramp on the site at once.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include "CVSLEStagger.h"
+
+#if (CVSLE_staggerMode == 1)
+
+
+//CVSLEStagger Object
+CVSLEStagger cvsStagger;
+
+
+//Begin function
+byte CVSLEStagger::begin(Stream &bus, byte unitID, byte dePin){
+
+	//Variables
+	byte result=0;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Check unit ID
+	 * 2) Init all variables and the slot table
+	 * 3) Seed backoff with the unit ID so identical units draw apart
+	 * 4) Setup driver enable pin
+	 *
+	 */
+
+
+	//Step 1 => Check unit ID
+	if(unitID>=CVSLE_staggerUnits){
+
+		return result;
+
+	}//EOP ID out of range
+
+	//Step 2 => init all variables
+	_bus=&bus;
+	_unitID=unitID;
+	_dePin=dePin;
+	_state=CVSLE_staggerIdle;
+	_window=CVSLE_staggerWindow;
+	_timer=0;
+	_lastHeartbeat=0;
+	_collisionCount=0;
+	_errorCount=0;
+	_frameLength=0;
+
+	for(byte i=0;i<CVSLE_staggerUnits;i++){
+
+		_heard[i]=0;
+		_active[i]=false;
+
+	}//EOP slot table
+
+	//Step 3 => Seed backoff
+	randomSeed( ((unsigned long)unitID<<16) ^ micros() );
+
+	//Step 4 => Driver enable, receive by default
+	if(_dePin!=CVSLE_staggerDEPin){
+
+		pinMode(_dePin,OUTPUT);
+		digitalWrite(_dePin,LOW);
+
+	}//EOP driver enable used
+
+	result=1;
+
+	//Return
+	return result;
+
+}//EOP begin
+
+
+//poll
+void CVSLEStagger::poll(){
+
+	//Variables
+	unsigned long now;
+
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Apply received frames
+	 * 2) Drop slots of silent units
+	 * 3) Step the slot negotiation
+	 * 4) Run the load while the slot is held or released after ramping
+	 *
+	 */
+
+
+	//Step 1 => Receive
+	_receive();
+
+	//Step 2 => Expire
+	_expire();
+
+	//Step 3 => Negotiate
+	now=millis();
+
+	switch(_state){
+
+		case CVSLE_staggerWait:
+
+			if( (long)(now-_timer)>=0 ){
+
+				if(getActiveCount()<CVSLE_staggerConcurrent){
+
+					//Claim and listen for competing claims
+					_send(CVSLE_staggerClaim);
+					_timer=now+CVSLE_staggerClaimMs;
+					_state=CVSLE_staggerClaiming;
+
+				}//EOP slot free
+				else{
+
+					_backoff();
+
+				}//EOP site full
+
+			}//EOP backoff elapsed
+
+			break;
+
+		case CVSLE_staggerClaiming:
+
+			if( (long)(now-_timer)>=0 ){
+
+				//Claim held through the window, slot granted
+				_active[_unitID]=true;
+				_window=CVSLE_staggerWindow;
+				_send(CVSLE_staggerBusy);
+				_heartbeat();
+				_state=CVSLE_staggerRamp;
+
+			}//EOP claim window over
+
+			break;
+
+		case CVSLE_staggerRamp:
+
+			if(cvsLE.motorMaxFlag){
+
+				//Inrush over, hand the slot on
+				_send(CVSLE_staggerDone);
+				_active[_unitID]=false;
+				_state=CVSLE_staggerRun;
+
+			}//EOP load max reached
+			else if( (long)(now-_lastHeartbeat)>=0 ){
+
+				_send(CVSLE_staggerBusy);
+				_heartbeat();
+
+			}//EOP heartbeat due
+
+			break;
+
+		default:
+
+			break;
+
+	}//EOP switch
+
+
+	//Step 4 => Soft start polling
+	if( (_state==CVSLE_staggerRamp) || (_state==CVSLE_staggerRun) ){
+
+		cvsLE.startLoadSoft();
+
+	}//EOP slot granted
+
+
+}//EOP poll
+
+
+//requestStart
+void CVSLEStagger::requestStart(){
+
+	//Check state
+	if(_state==CVSLE_staggerIdle){
+
+		_window=CVSLE_staggerWindow;
+		_backoff();
+		_state=CVSLE_staggerWait;
+
+	}//EOP idle
+
+
+}//EOP requestStart
+
+
+//stop
+void CVSLEStagger::stop(){
+
+	//Free a claimed or held slot
+	if( (_state==CVSLE_staggerClaiming) || (_state==CVSLE_staggerRamp) ){
+
+		_send(CVSLE_staggerDone);
+
+	}//EOP slot claimed
+
+	_active[_unitID]=false;
+	_state=CVSLE_staggerIdle;
+
+	cvsLE.stopLoad();
+
+}//EOP stop
+
+
+//getState
+byte CVSLEStagger::getState(){
+
+	//Return
+	return _state;
+
+}//EOP getState
+
+
+//getActiveCount
+byte CVSLEStagger::getActiveCount(){
+
+	//Variables
+	byte result=0;
+
+	for(byte i=0;i<CVSLE_staggerUnits;i++){
+
+		if(_active[i]){
+
+			result++;
+
+		}//EOP active
+
+	}//EOP slot table
+
+	//Return
+	return result;
+
+}//EOP getActiveCount
+
+
+//getCollisionCount
+uint16_t CVSLEStagger::getCollisionCount(){
+
+	//Return
+	return _collisionCount;
+
+}//EOP getCollisionCount
+
+
+//getErrorCount
+uint16_t CVSLEStagger::getErrorCount(){
+
+	//Return
+	return _errorCount;
+
+}//EOP getErrorCount
+
+
+//CRC-8 Maxim update
+byte CVSLEStagger::_crc8(byte crc, byte data){
+
+	crc^=data;
+
+	for(byte i=0;i<8;i++){
+
+		if(crc & 0x01){
+
+			crc=(crc>>1)^0x8C;
+
+		}//EOP lsb set
+		else{
+
+			crc=crc>>1;
+
+		}//EOP lsb clear
+
+	}//EOP bits
+
+	//Return
+	return crc;
+
+}//EOP _crc8
+
+
+//Receive frames
+void CVSLEStagger::_receive(){
+
+	while(_bus->available()>0){
+
+		byte data=_bus->read();
+
+		//Hunt for sync
+		if( (_frameLength==0) && (data!=CVSLE_staggerSync) ){
+
+			_error();
+
+			continue;
+
+		}//EOP not sync
+
+		_frame[_frameLength++]=data;
+
+		//Check frame
+		if(_frameLength==CVSLE_staggerFrame){
+
+			if(_crc8(_crc8(0, _frame[1]), _frame[2])==_frame[3]){
+
+				_apply(_frame[1], _frame[2]);
+
+			}//EOP CRC ok
+			else{
+
+				_error();
+
+			}//EOP CRC error
+
+			_frameLength=0;
+
+		}//EOP frame complete
+
+	}//EOP bytes available
+
+
+}//EOP _receive
+
+
+//Apply frame
+void CVSLEStagger::_apply(byte type, byte unit){
+
+	//Own echo or unknown unit
+	if( (unit==_unitID) || (unit>=CVSLE_staggerUnits) ){
+
+		return;
+
+	}//EOP ignore
+
+	switch(type){
+
+		case CVSLE_staggerClaim:
+
+			_active[unit]=true;
+			_heard[unit]=millis();
+
+			if(_state==CVSLE_staggerRamp){
+
+				//Tell the claimant this slot is taken
+				_send(CVSLE_staggerBusy);
+				_heartbeat();
+
+			}//EOP ramping
+			else if( (_state==CVSLE_staggerClaiming) && ((getActiveCount()+1)>CVSLE_staggerConcurrent) && (unit<_unitID) ){
+
+				//Competing claim over the limit, lower ID wins
+				_lose();
+
+			}//EOP collision
+
+			break;
+
+		case CVSLE_staggerBusy:
+
+			_active[unit]=true;
+			_heard[unit]=millis();
+
+			if( (_state==CVSLE_staggerClaiming) && ((getActiveCount()+1)>CVSLE_staggerConcurrent) ){
+
+				//Running ramp holds the slot
+				_lose();
+
+			}//EOP slot taken
+			else if( (_state==CVSLE_staggerRamp) && (getActiveCount()>CVSLE_staggerConcurrent) && (unit<_unitID) ){
+
+				//Claims collided unseen and both ramp, lower ID keeps the slot
+				_lose();
+
+			}//EOP double grant
+
+			break;
+
+		case CVSLE_staggerDone:
+
+			_active[unit]=false;
+
+			break;
+
+		default:
+
+			_errorCount++;
+
+			break;
+
+	}//EOP switch
+
+
+}//EOP _apply
+
+
+//Send frame
+void CVSLEStagger::_send(byte type){
+
+	//Variables
+	byte frame[CVSLE_staggerFrame];
+
+	frame[0]=CVSLE_staggerSync;
+	frame[1]=type;
+	frame[2]=_unitID;
+	frame[3]=_crc8(_crc8(0, type), _unitID);
+
+	if(_dePin!=CVSLE_staggerDEPin){
+
+		digitalWrite(_dePin,HIGH);
+
+	}//EOP driver on
+
+	_bus->write(frame, CVSLE_staggerFrame);
+	_bus->flush();
+
+	if(_dePin!=CVSLE_staggerDEPin){
+
+		digitalWrite(_dePin,LOW);
+
+	}//EOP driver off
+
+
+}//EOP _send
+
+
+//Backoff
+void CVSLEStagger::_backoff(){
+
+	_timer=millis()+(random(_window)*CVSLE_staggerSlotMs);
+
+}//EOP _backoff
+
+
+//Heartbeat
+void CVSLEStagger::_heartbeat(){
+
+	//Jitter keeps two heartbeats from colliding every period
+	_lastHeartbeat=millis()+CVSLE_staggerHeartbeatMs+(random(CVSLE_staggerWindow)*CVSLE_staggerSlotMs);
+
+}//EOP _heartbeat
+
+
+//Frame error
+void CVSLEStagger::_error(){
+
+	_errorCount++;
+
+	//Garbled frame while claiming is likely a colliding claim
+	if(_state==CVSLE_staggerClaiming){
+
+		_lose();
+
+	}//EOP claiming
+
+}//EOP _error
+
+
+//Lose claim
+void CVSLEStagger::_lose(){
+
+	//Withdraw so listeners free the slot at once
+	_send(CVSLE_staggerDone);
+
+	//Back off a ramp granted twice, it has barely left max firing delay
+	if(_state==CVSLE_staggerRamp){
+
+		_active[_unitID]=false;
+		cvsLE.stopLoad();
+
+	}//EOP ramping
+
+	_collisionCount++;
+
+	if(_window<CVSLE_staggerWindowMax){
+
+		_window=_window*2;
+
+	}//EOP widen window
+
+	_backoff();
+	_state=CVSLE_staggerWait;
+
+}//EOP _lose
+
+
+//Expire silent units
+void CVSLEStagger::_expire(){
+
+	//Variables
+	unsigned long now=millis();
+
+	for(byte i=0;i<CVSLE_staggerUnits;i++){
+
+		if( (i!=_unitID) && _active[i] && ((now-_heard[i])>CVSLE_staggerTimeoutMs) ){
+
+			_active[i]=false;
+
+		}//EOP silent
+
+	}//EOP slot table
+
+
+}//EOP _expire
+
+#endif
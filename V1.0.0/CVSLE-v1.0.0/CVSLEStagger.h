@@ -0,0 +1,210 @@
+/*
+ * CVSLEStagger.h
+ *
+ *
+ * Staggered start coordination for CVSLE units sharing one RS-485 line.
+ * Units that want to ramp at the same time, e.g. after a power restore,
+ * negotiate start slots so that at most CVSLE_staggerConcurrent soft starts
+ * run on the site at once and the summed inrush stays under the breaker.
+ *
+ * Every frame is 4 bytes:  sync | type | unit ID | CRC-8 (Maxim, over type
+ * and unit ID). A unit waiting to start backs off a random number of slots,
+ * and claims when fewer than CVSLE_staggerConcurrent ramps are heard. It
+ * then listens one claim window. A claim from another unit inside that
+ * window that would exceed the limit goes to the lower unit ID, a garbled
+ * frame or a heartbeat of a running ramp makes the claimant back off, and
+ * the loser doubles its backoff window and waits again. Claims that collide
+ * unseen, e.g. with driver and receiver enable tied, surface as two
+ * heartbeats and the higher ID stops its barely started ramp. A granted
+ * unit ramps with cvsLE.startLoadSoft(), sends a heartbeat while ramping
+ * and a done frame once motorMaxFlag is set, which frees its slot. Slots
+ * of units that go silent are dropped after CVSLE_staggerTimeoutMs.
+ *
+ * The line is any Arduino Stream, e.g. Serial1 behind a RS-485 driver. It
+ * must not be shared with CVSLEModbus, which answers a master only.
+ * Extras/staggerBus runs several units as host processes on a stand-in bus.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLESTAGGER_H_
+#define CVSLESTAGGER_H_
+
+#include <Arduino.h>
+
+#include "CVSLE.h"
+
+#define CVSLE_staggerMode 0 //Staggered start coordination enabled (1) or not (0)
+#define CVSLE_staggerConcurrent 1 //Soft starts allowed on the site at once
+#define CVSLE_staggerUnits 32 //Max unit IDs tracked, IDs 0 to CVSLE_staggerUnits-1
+#define CVSLE_staggerSlotMs 20 //Backoff slot, longer than a frame plus driver turnaround
+#define CVSLE_staggerWindow 8 //Initial random backoff window in slots
+#define CVSLE_staggerWindowMax 128 //Backoff window cap after repeated collisions
+#define CVSLE_staggerClaimMs 60 //Claim window listened to before ramping
+#define CVSLE_staggerHeartbeatMs 250 //Heartbeat period while ramping
+#define CVSLE_staggerTimeoutMs 1000 //Slot of a silent unit dropped after this
+#define CVSLE_staggerDEPin 255 //RS-485 driver enable pin, 255 for none
+
+//Frame
+#define CVSLE_staggerSync 0xC5 //Sync byte
+#define CVSLE_staggerFrame 4 //Frame length
+
+//Frame types
+#define CVSLE_staggerClaim 1 //Unit claims a start slot
+#define CVSLE_staggerBusy 2 //Unit is ramping, heartbeat
+#define CVSLE_staggerDone 3 //Unit reached load max or stopped, slot free
+
+//States
+#define CVSLE_staggerIdle 0 //No start requested
+#define CVSLE_staggerWait 1 //Start requested, backing off
+#define CVSLE_staggerClaiming 2 //Claim sent, listening for competing claims
+#define CVSLE_staggerRamp 3 //Slot granted, soft start running
+#define CVSLE_staggerRun 4 //Load max reached, slot released
+
+
+#if (CVSLE_staggerMode == 1)
+
+class CVSLEStagger {
+
+
+public:
+
+	byte begin(Stream &bus, byte unitID, byte dePin = CVSLE_staggerDEPin);
+	/*!
+	 * @brief Inits the coordinator on a bus already opened by the sketch
+	 * @return Returns "1" for success and "0" for a unit ID out of range
+	 */
+
+
+	void poll();
+	/*!
+	 * @brief Handle received frames, negotiate the slot and run or stop
+	 * the load. Call from loop() in place of cvsLE.startLoadSoft()
+	 * @return void
+	 */
+
+
+	void requestStart();
+	/*!
+	 * @brief Ask for a start slot, the load ramps once it is granted
+	 * @return void
+	 */
+
+
+	void stop();
+	/*!
+	 * @brief Withdraw the request, stop the load and free a held slot
+	 * @return void
+	 */
+
+
+	byte getState();
+	/*!
+	 * @brief Get coordinator state
+	 * @return CVSLE_staggerIdle, Wait, Claiming, Ramp or Run
+	 */
+
+
+	byte getActiveCount();
+	/*!
+	 * @brief Get ramps heard on the bus, this unit included
+	 * @return Active ramp count
+	 */
+
+
+	uint16_t getCollisionCount();
+	/*!
+	 * @brief Get claims lost to another unit since begin
+	 * @return Collision count
+	 */
+
+
+	uint16_t getErrorCount();
+	/*!
+	 * @brief Get frames dropped for sync or CRC errors
+	 * @return Error count
+	 */
+
+
+private:
+
+	Stream *_bus;
+	byte _unitID;
+	byte _dePin;
+	byte _state;
+	uint16_t _window;
+	unsigned long _timer;
+	unsigned long _lastHeartbeat; //Next heartbeat due
+	uint16_t _collisionCount;
+	uint16_t _errorCount;
+
+	unsigned long _heard[CVSLE_staggerUnits];
+	bool _active[CVSLE_staggerUnits];
+
+	byte _frame[CVSLE_staggerFrame];
+	byte _frameLength;
+
+
+	static byte _crc8(byte crc, byte data);
+	/*
+	 * @brief Update Maxim CRC-8 with one byte
+	 */
+
+	void _receive();
+	/*
+	 * @brief Assemble received bytes into frames and apply them
+	 */
+
+	void _apply(byte type, byte unit);
+	/*
+	 * @brief Update the slot table from a frame of another unit
+	 */
+
+	void _send(byte type);
+	/*
+	 * @brief Send a frame, driving the driver enable pin around it
+	 */
+
+	void _backoff();
+	/*
+	 * @brief Draw a random backoff inside the current window
+	 */
+
+	void _heartbeat();
+	/*
+	 * @brief Schedule the next heartbeat with random jitter
+	 */
+
+	void _error();
+	/*
+	 * @brief Count a frame error, a claim in progress backs off
+	 */
+
+	void _lose();
+	/*
+	 * @brief Give up a claim or double granted ramp, widen the backoff
+	 * window and wait again
+	 */
+
+	void _expire();
+	/*
+	 * @brief Drop slots of units not heard within the timeout
+	 */
+
+
+};//EOP class
+
+
+extern CVSLEStagger cvsStagger;
+
+#endif
+
+#endif /* CVSLESTAGGER_H_ */
@@ -0,0 +1,305 @@
+/*
+ * CVSLETelemetry.cpp
+ *
+ *
+ * Compact binary telemetry for CVSLE. One fixed size, CRC framed record is
+ * queued from the zero-detect ISR every half cycle and sent by the USART data
+ * register empty interrupt, so neither side ever blocks.
+ *
+ * WORKS ONLY IN AVR Architecture boards. Drives the selected USART directly
+ * through its interrupts, so the matching Arduino SerialN object must not be
+ * used in the same sketch.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include "CVSLETelemetry.h"
+
+#if (CVSLE_telemetryMode == 1)
+
+#include <util/crc16.h>
+
+
+//CVSLETelemetry Object
+CVSLETelemetry cvsTelemetry;
+
+
+//Begin function
+byte CVSLETelemetry::begin(unsigned long baud){
+
+	//Variables
+	byte result=0;
+
+
+	/*
+	 * The following tasks will be performed:
+	 * 1) Init all variables
+	 * 2) Init USART register pointers based on selected USART
+	 * 3) Setup USART for 8N1 transmit only
+	 *
+	 */
+
+
+	//Step 1 => init all variables
+	_ready=false;
+	_sequence=0;
+	_dropped=false;
+	_droppedCount=0;
+	_head=0;
+	_tail=0;
+	_txIndex=0;
+	_crc=0xFFFF;
+
+
+	//Step 2 => USART init
+#if (CVSLE_telemetryUSART == 0)
+
+	_data_T=&UDR0;
+	_statusA_T=&UCSR0A;
+	_control_T=&UCSR0B;
+	_frameFormat_T=&UCSR0C;
+	_baud_T=&UBRR0;
+
+	result=1;
+
+
+#elif (CVSLE_telemetryUSART == 1) && defined(UDR1)
+
+	_data_T=&UDR1;
+	_statusA_T=&UCSR1A;
+	_control_T=&UCSR1B;
+	_frameFormat_T=&UCSR1C;
+	_baud_T=&UBRR1;
+
+	result=1;
+
+
+#elif (CVSLE_telemetryUSART == 2) && defined(UDR2)
+
+	_data_T=&UDR2;
+	_statusA_T=&UCSR2A;
+	_control_T=&UCSR2B;
+	_frameFormat_T=&UCSR2C;
+	_baud_T=&UBRR2;
+
+	result=1;
+
+
+#elif (CVSLE_telemetryUSART == 3) && defined(UDR3)
+
+	_data_T=&UDR3;
+	_statusA_T=&UCSR3A;
+	_control_T=&UCSR3B;
+	_frameFormat_T=&UCSR3C;
+	_baud_T=&UBRR3;
+
+	result=1;
+
+
+#else
+	result=0;
+
+
+#endif
+
+	//Check result
+	if(result!=0){
+
+		//Step 3 => Setup USART
+		noInterrupts();
+
+		*_control_T=0;
+		*_statusA_T=(1 << U2X0);   // double speed
+		*_baud_T=((F_CPU/4UL/baud)-1)/2;   // rounded, as HardwareSerial
+		*_frameFormat_T=(1 << UCSZ01) | (1 << UCSZ00);   // 8N1
+		*_control_T=(1 << TXEN0);   // data register empty interrupt enabled on demand
+
+		_ready=true;
+
+		interrupts();
+
+	}//EOP result OK
+
+	//Return statement
+	return result;
+
+}//EOP begin function
+
+
+//push
+void CVSLETelemetry::push(uint16_t period, uint16_t compare, byte state, byte fault){
+
+	//Variables
+	byte next=(_head+1) & (CVSLE_telemetryQueue-1);
+	byte *record=_queue[_head];
+
+	//Check USART
+	if(!_ready){
+
+		return;
+
+	}//EOP not started
+
+	//Check queue space
+	if(next==_tail){
+
+		_dropped=true;
+		_droppedCount++;
+
+		return;
+
+	}//EOP queue full
+
+	//Fill record
+	record[0]=_sequence;
+	record[1]=period & 0xFF;
+	record[2]=period >> 8;
+	record[3]=compare & 0xFF;
+	record[4]=compare >> 8;
+	record[5]=state;
+	record[6]=fault | (_dropped?CVSLE_faultDropped:0);
+
+	_dropped=false;
+	_sequence++;
+	_head=next;
+
+	//Start transmission
+	*_control_T |= (1 << UDRIE0);
+
+
+}//EOP push
+
+
+//getDroppedCount
+uint16_t CVSLETelemetry::getDroppedCount(){
+
+	//Variables
+	uint16_t result=0;
+
+	noInterrupts();
+	result=_droppedCount;
+	interrupts();
+
+	//Return
+	return result;
+
+}//EOP getDroppedCount
+
+
+
+//****************************
+//  Interrupt Function
+//****************************
+
+#if (CVSLE_telemetryUSART == 0)
+
+#if defined(USART0_UDRE_vect)
+ISR(USART0_UDRE_vect){
+#else
+ISR(USART_UDRE_vect){
+#endif
+
+	cvsTelemetry.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+#elif (CVSLE_telemetryUSART == 1) && defined(UDR1)
+
+ISR(USART1_UDRE_vect){
+
+	cvsTelemetry.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+#elif (CVSLE_telemetryUSART == 2) && defined(UDR2)
+
+ISR(USART2_UDRE_vect){
+
+	cvsTelemetry.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+#elif (CVSLE_telemetryUSART == 3) && defined(UDR3)
+
+ISR(USART3_UDRE_vect){
+
+	cvsTelemetry.udreInterruptRoutine();
+
+}//EOP data register empty ISR
+
+
+#endif
+
+
+//udreInterruptRoutine
+void CVSLETelemetry::udreInterruptRoutine()
+{
+
+	//Variables
+	byte data=0;
+
+	//Check queue
+	if(_head==_tail){
+
+		//Nothing left, stop interrupt
+		*_control_T &= ~(1 << UDRIE0);
+
+		return;
+
+	}//EOP queue empty
+
+	//Byte of the record at the tail
+	if(_txIndex==0){
+
+		data=CVSLE_telemetrySync0;
+		_crc=0xFFFF;
+
+	}//EOP first sync
+	else if(_txIndex==1){
+
+		data=CVSLE_telemetrySync1;
+
+	}//EOP second sync
+	else if(_txIndex<(2+CVSLE_telemetryPayload)){
+
+		data=_queue[_tail][_txIndex-2];
+		_crc=_crc_ccitt_update(_crc, data);
+
+	}//EOP payload
+	else if(_txIndex==(2+CVSLE_telemetryPayload)){
+
+		data=_crc & 0xFF;
+
+	}//EOP crc low
+	else{
+
+		data=_crc >> 8;
+
+	}//EOP crc high
+
+	*_data_T=data;
+	_txIndex++;
+
+	//Check end of record
+	if(_txIndex>=CVSLE_telemetryFrame){
+
+		_txIndex=0;
+		_tail=(_tail+1) & (CVSLE_telemetryQueue-1);
+
+	}//EOP record sent
+
+
+}//EOP udreInterruptRoutine
+
+#endif
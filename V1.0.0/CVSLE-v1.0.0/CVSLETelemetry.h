@@ -0,0 +1,111 @@
+/*
+ * CVSLETelemetry.h
+ *
+ *
+ * Compact binary telemetry for CVSLE. One fixed size, CRC framed record is
+ * queued from the zero-detect ISR every half cycle and sent by the USART data
+ * register empty interrupt, so neither side ever blocks.
+ *
+ * Record layout, multi-byte fields little endian:
+ *  0xA5 0x5A | sequence | period (2, ZD counts) | compare (2, PT counts) |
+ *  state (CVSLE_state* bits) | fault (CVSLE_fault* bits) | CRC (2)
+ * CRC is CRC-CCITT (avr-libc _crc_ccitt_update, init 0xFFFF) over sequence
+ * to fault. Extras/telemetryDecoder decodes the stream on a host.
+ *
+ * WORKS ONLY IN AVR Architecture boards. Drives the selected USART directly
+ * through its interrupts, so the matching Arduino SerialN object must not be
+ * used in the same sketch.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLETELEMETRY_H_
+#define CVSLETELEMETRY_H_
+
+#include <Arduino.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#define CVSLE_telemetryMode 0 //Half cycle telemetry stream enabled (1) or not (0)
+#define CVSLE_telemetryUSART 0 //USART used for the stream
+#define CVSLE_telemetryBaud 115200 //Default baud rate
+#define CVSLE_telemetryQueue 16 //Queued records, power of 2
+#define CVSLE_telemetrySync0 0xA5 //First sync byte
+#define CVSLE_telemetrySync1 0x5A //Second sync byte
+#define CVSLE_telemetryPayload 7 //Record bytes covered by CRC
+#define CVSLE_telemetryFrame 11 //Record bytes on the wire
+
+#define CVSLE_faultDropped 0x80 //Fault bit, telemetry records dropped before this one
+
+
+#if (CVSLE_telemetryMode == 1)
+
+class CVSLETelemetry {
+
+
+public:
+
+	byte begin(unsigned long baud = CVSLE_telemetryBaud);
+	/*!
+	 * @brief Inits the USART and record queue
+	 * @return Returns "1" for success and "0" for failure
+	 */
+
+
+	void push(uint16_t period, uint16_t compare, byte state, byte fault);
+	/*!
+	 * @brief Queue one record. Call from ISR context only
+	 * @return void
+	 */
+
+
+	uint16_t getDroppedCount();
+	/*!
+	 * @brief Get number of records dropped on a full queue
+	 * @return Dropped record count
+	 */
+
+
+	void udreInterruptRoutine();
+	/*
+	 * @brief Custom function for USART data register empty ISR
+	 */
+
+private:
+
+	bool _ready;
+	byte _sequence;
+	bool _dropped;
+	uint16_t volatile _droppedCount;
+
+	byte _queue[CVSLE_telemetryQueue][CVSLE_telemetryPayload];
+	byte volatile _head;
+	byte volatile _tail;
+	byte _txIndex;
+	uint16_t _crc;
+
+
+	uint8_t volatile *  _data_T;
+	uint8_t volatile *  _statusA_T;
+	uint8_t volatile *  _control_T;
+	uint8_t volatile *  _frameFormat_T;
+	uint16_t volatile *  _baud_T;
+
+
+};//EOP class
+
+
+extern CVSLETelemetry cvsTelemetry;
+
+#endif
+
+#endif /* CVSLETELEMETRY_H_ */
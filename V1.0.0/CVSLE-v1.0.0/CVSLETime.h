@@ -0,0 +1,135 @@
+/*
+ * CVSLETime.h
+ *
+ *
+ * Compile time unit safe durations for CVSLE. A duration is a count of one
+ * unit, the unit is part of its type, so ticks cannot be passed where half
+ * cycles are expected. Units are given in nanoseconds per count; the timer
+ * tick follows F_CPU and CVSLE_timerPrescaler, the half cycle CVSLE_ZDF.
+ *
+ * Converting to a finer unit that divides the source exactly, e.g. seconds
+ * to milliSecs or half cycles to ticks, is implicit. Any other conversion
+ * needs cvsleDurationCast, which truncates like integer division. The ratio
+ * between two units is reduced at compile time, so a conversion is a single
+ * 32 bit multiply or divide by a constant and folds away on constant counts.
+ * Where neither unit divides the other, as 60 Hz half cycles and milliSecs
+ * do, the cast scales through 64 bits. Counts are 32 bit, keep the converted
+ * count below 2^32.
+ *
+ * Included from CVSLE.h after the configuration, not on its own.
+ *
+ * Saryam invests time and resources providing this open source code,
+ * please support Saryam and open-source hardware by purchasing
+ * products from Saryam!
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef CVSLETIME_H_
+#define CVSLETIME_H_
+
+#include <Arduino.h>
+
+
+//Nanoseconds per count of each unit
+#define CVSLE_tickNS ((uint32_t)((1000000000ULL*CVSLE_timerPrescaler)/F_CPU)) //PT and ZD timer tick
+#define CVSLE_halfCycleNS ((uint32_t)(1000000000UL/(2*CVSLE_ZDF))) //Nominal mains half cycle
+
+
+//Greatest common divisor, reduces unit ratios at compile time
+constexpr uint32_t cvsleGCD(uint32_t a, uint32_t b){
+
+	return (b==0) ? a : cvsleGCD(b, a%b);
+
+}//EOP cvsleGCD
+
+
+//Enable a template only when the condition holds, no <type_traits> on AVR
+template<bool condition, typename T=void> struct CVSLEEnableIf {};
+template<typename T> struct CVSLEEnableIf<true, T> { typedef T type; };
+
+
+template<uint32_t NS> class CVSLEDuration {
+
+
+public:
+
+	static constexpr uint32_t nanos=NS;
+
+
+	constexpr CVSLEDuration() : _count(0) {}
+
+	constexpr explicit CVSLEDuration(uint32_t count) : _count(count) {}
+	/*!
+	 * @brief Duration of count units
+	 */
+
+
+	template<uint32_t fromNS, typename=typename CVSLEEnableIf<( (fromNS%NS)==0 )>::type>
+	constexpr CVSLEDuration(const CVSLEDuration<fromNS> &from) : _count(from.count()*(fromNS/NS)) {}
+	/*!
+	 * @brief Exact conversion from a coarser unit
+	 */
+
+
+	constexpr uint32_t count() const { return _count; }
+	/*!
+	 * @brief Get count of units
+	 * @return Count
+	 */
+
+
+	constexpr CVSLEDuration operator+(const CVSLEDuration &other) const { return CVSLEDuration(_count+other._count); }
+	constexpr CVSLEDuration operator-(const CVSLEDuration &other) const { return CVSLEDuration(_count-other._count); }
+	constexpr CVSLEDuration operator*(uint32_t factor) const { return CVSLEDuration(_count*factor); }
+	constexpr CVSLEDuration operator/(uint32_t divisor) const { return CVSLEDuration(_count/divisor); }
+
+	constexpr bool operator==(const CVSLEDuration &other) const { return _count==other._count; }
+	constexpr bool operator!=(const CVSLEDuration &other) const { return _count!=other._count; }
+	constexpr bool operator<(const CVSLEDuration &other) const { return _count<other._count; }
+	constexpr bool operator<=(const CVSLEDuration &other) const { return _count<=other._count; }
+	constexpr bool operator>(const CVSLEDuration &other) const { return _count>other._count; }
+	constexpr bool operator>=(const CVSLEDuration &other) const { return _count>=other._count; }
+
+
+private:
+
+	uint32_t _count;
+
+
+};//EOP class
+
+
+//Units
+typedef CVSLEDuration<CVSLE_tickNS> CVSLETicks; //PT and ZD timer counts
+typedef CVSLEDuration<1000UL> CVSLEMicros;
+typedef CVSLEDuration<1000000UL> CVSLEMillis;
+typedef CVSLEDuration<1000000000UL> CVSLESeconds;
+typedef CVSLEDuration<CVSLE_halfCycleNS> CVSLEHalfCycles; //Nominal mains half cycles
+
+
+//Convert to unit To, truncating
+template<typename To, uint32_t fromNS>
+constexpr To cvsleDurationCast(const CVSLEDuration<fromNS> &from){
+
+	return To( ( ((fromNS/cvsleGCD(fromNS, To::nanos))==1) || ((To::nanos/cvsleGCD(fromNS, To::nanos))==1) ) ?
+		(from.count()*(fromNS/cvsleGCD(fromNS, To::nanos)))/(To::nanos/cvsleGCD(fromNS, To::nanos)) :
+		(uint32_t)( ((uint64_t)from.count()*(fromNS/cvsleGCD(fromNS, To::nanos)))/(To::nanos/cvsleGCD(fromNS, To::nanos)) ) );
+
+}//EOP cvsleDurationCast
+
+
+//Convert to a fractional count of unit To, ratio folded to one float constant
+template<typename To, uint32_t fromNS>
+constexpr float cvsleDurationFloat(const CVSLEDuration<fromNS> &from){
+
+	return from.count()*((float)fromNS/(float)To::nanos);
+
+}//EOP cvsleDurationFloat
+
+
+#endif /* CVSLETIME_H_ */
@@ -0,0 +1,37 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+#include "CVSLERecorder.h"
+
+/*
+ * Set CVSLE_recorderMode to 1 in CVSLERecorder.h before building this sketch.
+ * After a fault, a stop of the running load or a reset, the last half cycles
+ * are printed as CSV, then the recorder is rearmed.
+ */
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+  if(cvsRecorder.getReason()!=CVSLE_freezeNone){
+
+    cvsRecorder.dump(Serial);
+    cvsRecorder.rearm();
+
+  }
+
+}
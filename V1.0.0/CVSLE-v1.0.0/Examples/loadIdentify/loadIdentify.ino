@@ -0,0 +1,41 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_loadIDMode to 1 in CVSLE.h before building this sketch, along
+ * with CVSLE_adaptiveStartMode or CVSLE_meteringMode for the current sensor
+ * on CVSLE_currentChannel. identifyLoad() briefly fires the load, so run it
+ * with the load connected and safe to energise.
+ */
+
+const char *loadNames[]={"unknown", "resistive", "inductive", "motor", "capacitive"};
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  byte loadType=cvsLE.identifyLoad();
+
+  Serial.print("Load ");
+  Serial.print(loadNames[loadType]);
+  Serial.print(", lag ");
+  Serial.print(cvsLE.getLoadLag());
+  Serial.print(" counts, ");
+  Serial.println(cvsLE.getIntegralCycle() ? "integral cycle" : "phase angle");
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+}
@@ -0,0 +1,42 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_timeBaseMode to 1 in CVSLE.h before building this sketch.
+ * Soft start ramps and CVSLE timeouts then run on mains half cycles, with
+ * the crystal carrying the count on while mains is absent. The sketch
+ * schedules its own work on getTimeMillis() instead of millis().
+ */
+
+unsigned long lastPrint=0;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+  if(cvsLE.getTimeMillis()-lastPrint>=1000){
+
+    lastPrint=cvsLE.getTimeMillis();
+
+    Serial.print(cvsLE.getHalfCycleCount());
+    Serial.print(" half cycles, ");
+    Serial.println(cvsLE.getTimeBaseLocked() ? "mains" : "crystal");
+
+  }
+
+}
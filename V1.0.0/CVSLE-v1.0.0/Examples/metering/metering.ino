@@ -0,0 +1,46 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_meteringMode to 1 in CVSLE.h before building this sketch.
+ * Voltage sensor on A1, load current sensor on A0, both biased to mid rail.
+ * Adjust CVSLE_voltageScale and CVSLE_currentScale to the sensors used.
+ */
+
+unsigned long lastPrint=0;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+  if(millis()-lastPrint>1000){
+
+    lastPrint=millis();
+
+    Serial.print(cvsLE.getRMSVoltage());
+    Serial.print(" V, ");
+    Serial.print(cvsLE.getRMSCurrent());
+    Serial.print(" A, ");
+    Serial.print(cvsLE.getRealPower());
+    Serial.print(" W, ");
+    Serial.print(cvsLE.getEnergy());
+    Serial.println(" Wh");
+
+  }
+
+}
@@ -0,0 +1,40 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+#include "CVSLEModbus.h"
+
+/*
+ * Set CVSLE_modbusMode to 1 in CVSLEModbus.h before building this sketch.
+ *
+ * Holding registers (function 03/04 read, 06/16 write):
+ *  0 - load max %
+ *  1 - soft start interval in seconds
+ *  2 - run (1) / stop (0)
+ *  3 - input frequency in 0.01 Hz
+ *  4 - state, bit 0 motorStatus, bit 1 motorMaxFlag
+ *
+ * Any Modbus RTU master on a PC with a USB to RS-485 adapter can stand in
+ * for the supervisory panel. Extras/modbusLoopback runs the slave against a
+ * simulated line and master on the host, no board needed.
+ */
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  cvsLE.begin(18, 5, 6, false);
+
+  //Slave address 1, 19200 baud, driver enable on pin 4
+  cvsModbus.begin(1, 19200, 4);
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  //Handles frames and runs startLoadSoft() while the run register is 1
+  cvsModbus.poll();
+
+}
@@ -0,0 +1,63 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_powerQualityMode to 1 in CVSLE.h before building this sketch.
+ * Prints supply statistics of the last window, the period histogram and
+ * dropout counters every 5 seconds.
+ */
+
+unsigned long lastPrint=0;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  if(millis()-lastPrint>5000){
+
+    lastPrint=millis();
+
+    Serial.print("Half cycle us min/mean/max: ");
+    Serial.print(cvsLE.getPeriodMin());
+    Serial.print(" / ");
+    Serial.print(cvsLE.getPeriodMean());
+    Serial.print(" / ");
+    Serial.println(cvsLE.getPeriodMax());
+
+    Serial.print("Variance us2: ");
+    Serial.print(cvsLE.getPeriodVariance());
+    Serial.print(", RoCoF Hz/s: ");
+    Serial.println(cvsLE.getRoCoF(), 4);
+
+    Serial.print("Histogram:");
+    for(byte i=0;i<CVSLE_pqBins;i++){
+
+      Serial.print(" ");
+      Serial.print(cvsLE.getPeriodHistogram(i));
+
+    }
+    Serial.println();
+
+    Serial.print("Dropouts: ");
+    Serial.print(cvsLE.getDropoutCount());
+    Serial.print(", longest ms: ");
+    Serial.print(cvsLE.getLongestDropout());
+    Serial.print(", glitches: ");
+    Serial.println(cvsLE.getGlitchCount());
+
+  }
+
+}
@@ -0,0 +1,41 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_bypassMode to 1 in CVSLE.h before building this sketch and wire
+ * a bypass contactor, driven from CVSLE_bypassPin, across the triac after
+ * the load relay. Set CVSLE_bypassOperateCycles and CVSLE_bypassReleaseCycles
+ * to cover the contactor operate and release times.
+ */
+
+byte lastState=CVSLE_bypassOpen;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+  if(cvsLE.getBypassState()!=lastState){
+
+    lastState=cvsLE.getBypassState();
+
+    Serial.print("Bypass state ");
+    Serial.println(lastState);
+
+  }
+
+}
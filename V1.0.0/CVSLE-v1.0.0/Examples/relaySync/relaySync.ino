@@ -0,0 +1,57 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_relaySyncMode to 1 in CVSLE.h before building this sketch. Set
+ * CVSLE_relayOperateUS and CVSLE_relayReleaseUS from the relay datasheet,
+ * or wire its auxiliary contact to CVSLE_relaySensePin so the delays are
+ * learned on every switching. The load is cycled every 10 seconds and the
+ * delays are printed after each stop.
+ */
+
+unsigned long lastToggle=0;
+bool run=false;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  if(millis()-lastToggle>10000){
+
+    lastToggle=millis();
+    run=!run;
+
+    if(!run){
+
+      cvsLE.stopLoad();
+
+      Serial.print("Operate ");
+      Serial.print(cvsLE.getRelayOperateDelay());
+      Serial.print(" us, release ");
+      Serial.print(cvsLE.getRelayReleaseDelay());
+      Serial.println(cvsLE.getRelayDegraded() ? " us, replace relay" : " us");
+
+    }
+
+  }
+
+  if(run){
+
+    cvsLE.startLoadSoft();
+
+  }
+
+}
@@ -0,0 +1,44 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_scheduleMode to 1 in CVSLE.h before building this sketch.
+ * Starts the load 1 second after setup, drops to 60% after a 30 second run,
+ * then stops 10 seconds later. All steps happen on exact zero-crossings
+ * (100 per second on 50Hz mains) even while loop() is busy.
+ * Do not call startLoadSoft or stopLoad while a schedule is running.
+ */
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+
+  uint32_t now=cvsLE.getHalfCycleCount();
+
+  cvsLE.scheduleAt(now+100, CVSLE_actionStart);
+  cvsLE.scheduleAt(now+3100, CVSLE_actionLoadMax, 60);
+  cvsLE.scheduleAt(now+4100, CVSLE_actionStop);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  Serial.print("Half cycles: ");
+  Serial.print(cvsLE.getHalfCycleCount());
+  Serial.print(", running: ");
+  Serial.print(cvsLE.getScheduledRun());
+  Serial.print(", pending: ");
+  Serial.println(cvsLE.getScheduleCount());
+
+  delay(1000);
+
+}
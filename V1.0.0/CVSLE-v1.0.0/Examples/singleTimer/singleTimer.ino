@@ -0,0 +1,29 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * For ATmega328P boards (Uno, Nano, Pro Mini).
+ * Set CVSLE_singleTimerMode to 1 in CVSLE.h before building this sketch.
+ * Zero-detect on pin 2 (INT0), triac driver on pin 5, load relay on pin 6.
+ */
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(2, 5, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+}
@@ -0,0 +1,38 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+#include "CVSLEStagger.h"
+
+/*
+ * Set CVSLE_staggerMode to 1 in CVSLEStagger.h before building this sketch.
+ *
+ * Every unit on the RS-485 line runs this sketch with its own UNIT_ID. After
+ * a power restore all units ask for a start at once, the coordinator lets
+ * CVSLE_staggerConcurrent of them ramp at a time.
+ */
+
+#define UNIT_ID 0
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  cvsLE.begin(18, 5, 6, false);
+
+  //Line on Serial1, driver enable on pin 4
+  Serial1.begin(19200);
+  cvsStagger.begin(Serial1, UNIT_ID, 4);
+
+  cvsStagger.requestStart();
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  //Negotiates the slot and runs startLoadSoft() once it is granted
+  cvsStagger.poll();
+
+}
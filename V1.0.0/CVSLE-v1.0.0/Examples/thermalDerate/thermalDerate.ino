@@ -0,0 +1,44 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_thermalMode to 1 in CVSLE.h before building this sketch.
+ * Set CVSLE_thermalRth, CVSLE_thermalTau and CVSLE_thermalLoss to the triac
+ * and heatsink used. With CVSLE_meteringMode also set to 1 the loss follows
+ * the measured load current instead of the conduction angle.
+ */
+
+unsigned long lastPrint=0;
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.begin(18, 5, 6, false);
+  cvsLE.setAmbientTemperature(35.0);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  cvsLE.startLoadSoft();
+
+  if(millis()-lastPrint>1000){
+
+    lastPrint=millis();
+
+    Serial.print(cvsLE.getJunctionTemperature());
+    Serial.print(" degC, derate ");
+    Serial.print(cvsLE.getThermalDerate());
+    Serial.println(" %");
+
+  }
+
+}
@@ -0,0 +1,33 @@
+#include "Arduino.h"
+
+#include "CVSLE.h"
+
+/*
+ * Set CVSLE_threePhaseMode to 1 in CVSLE.h before building this sketch.
+ */
+
+//The setup function is called once at startup of the sketch
+void setup()
+{
+// Add your initialization code here
+  Serial.begin(115200);
+  cvsLE.beginThreePhase(18, 19, 20, 5, 7, 8, 6, false);
+
+  Serial.println("Setup Completed");
+
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+//Add your repeated code here
+
+  if(cvsLE.getPhaseStatus()!=CVSLE_phaseOK){
+
+    Serial.println("Phase fault");
+
+  }
+
+  cvsLE.startLoadSoft();
+
+}
@@ -0,0 +1,811 @@
+/*
+ * digitalTwin.cpp
+ *
+ *
+ * Host side digital twin for tuning CVSLE soft start ramps. The real
+ * CVSLE.cpp is compiled against the shim headers in shim/, so the library's
+ * own ISRs, ramp and firing logic drive a simulated triac and universal
+ * motor with a fan load. Every zero-cross, compare, overflow, ADC conversion
+ * and main loop call lands on its own 16us timer tick, the quiet ticks in
+ * between are skipped in bulk and the plant is integrated in 128us steps
+ * while the triac conducts. A start runs a few thousand times faster than
+ * real time.
+ *
+ * Every combination of soft start interval and load max given on the
+ * command line is simulated from standstill. One CSV line is printed per
+ * start with the inrush current peak, the time to reach 95% of final speed,
+ * the energy drawn and the final speed.
+ *
+ * Build:  g++ -O2 -Ishim -I../.. -o digitalTwin digitalTwin.cpp shim/Arduino.cpp ../../CVSLE.cpp
+ * Use:    ./digitalTwin -i 5,10,20 -m 60,80,100 -t 25
+ *         ./digitalTwin -help
+ *
+ * Ramp constants such as CVSLE_PTTCDIV are compile time settings in CVSLE.h,
+ * rebuild after changing them. Single phase timer ISR backends are modelled,
+ * CVSLE_adaptiveStartMode and CVSLE_meteringMode see the simulated current
+ * and voltage on the ADC.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <vector>
+
+#include "CVSLE.h"
+
+#if (CVSLE_threePhaseMode == 1) || (CVSLE_eventSystemMode == 1)
+#error "digitalTwin models a single phase load on the timer ISR backend"
+#endif
+
+#define CVSLE_twinTickUs 16 //Timer tick at 16MHz/256 in microseconds
+#define CVSLE_twinADCTicks 7 //ADC conversion time, 13 clocks at /128
+#define CVSLE_twinSpeedBand 0.95 //Fraction of final speed for time to speed
+#define CVSLE_twinListMax 32 //Max values in a -i or -m list
+#define CVSLE_twinPlantTicks 8 //Ticks per plant step while the triac conducts
+
+
+//****************************
+//  Shim state
+//****************************
+
+//Vectors CVSLE.cpp does not define stay null
+#define CVSLE_SHIM_VECTORS(n) \
+	extern "C" void TIMER##n##_COMPA_vect(void) __attribute__((weak)); \
+	extern "C" void TIMER##n##_COMPB_vect(void) __attribute__((weak)); \
+	extern "C" void TIMER##n##_OVF_vect(void) __attribute__((weak));
+
+CVSLE_SHIM_VECTORS(1)
+CVSLE_SHIM_VECTORS(3)
+CVSLE_SHIM_VECTORS(4)
+CVSLE_SHIM_VECTORS(5)
+
+extern "C" void ADC_vect(void) __attribute__((weak));
+
+static uint64_t simTicks;
+
+
+unsigned long millis(){
+
+	return (unsigned long)((simTicks*CVSLE_twinTickUs)/1000);
+
+}//EOP millis
+
+
+unsigned long micros(){
+
+	return (unsigned long)(simTicks*CVSLE_twinTickUs);
+
+}//EOP micros
+
+
+//****************************
+//  Timer and ADC model
+//****************************
+
+struct TwinTimer {
+
+	volatile uint16_t *counter;
+	volatile uint16_t *compareA;
+	volatile uint16_t *compareB;
+	volatile uint8_t *control;
+	volatile uint8_t *mask;
+	volatile uint8_t *flags;
+	void (*compareAVector)(void);
+	void (*compareBVector)(void);
+	void (*overflowVector)(void);
+	uint8_t pending;
+
+};//EOP struct
+
+
+#define CVSLE_SHIM_TIMER_INIT(n) { &TCNT##n, &OCR##n##A, &OCR##n##B, &TCCR##n##B, &TIMSK##n, &TIFR##n, TIMER##n##_COMPA_vect, TIMER##n##_COMPB_vect, TIMER##n##_OVF_vect, 0 }
+
+static TwinTimer timers[]={ CVSLE_SHIM_TIMER_INIT(1), CVSLE_SHIM_TIMER_INIT(3), CVSLE_SHIM_TIMER_INIT(4), CVSLE_SHIM_TIMER_INIT(5) };
+
+static byte adcTicks;
+
+
+//Advance one timer by one tick and run its due vectors
+static void timerTick(TwinTimer *t){
+
+	//Flags are write one to clear on the part
+	t->pending&=~(*t->flags);
+	*t->flags=0;
+
+	//Clock select, all CVSLE timers run at /256
+	if( (*t->control & 0x07)==0 ){
+
+		return;
+
+	}//EOP stopped
+
+	(*t->counter)++;
+
+	if(*t->counter==0){
+
+		t->pending|=(1 << TOV1);
+
+	}//EOP overflow
+
+	if(*t->counter==*t->compareA){
+
+		t->pending|=(1 << OCF1A);
+
+	}//EOP compare A
+
+	if(*t->counter==*t->compareB){
+
+		t->pending|=(1 << OCF1B);
+
+	}//EOP compare B
+
+	//Vectors in AVR priority order
+	if( (t->pending & (1 << OCF1A)) && (*t->mask & (1 << OCIE1A)) ){
+
+		t->pending&=~(1 << OCF1A);
+
+		if(t->compareAVector){
+
+			t->compareAVector();
+
+		}//EOP vector defined
+
+	}//EOP compare A due
+
+	if( (t->pending & (1 << OCF1B)) && (*t->mask & (1 << OCIE1B)) ){
+
+		t->pending&=~(1 << OCF1B);
+
+		if(t->compareBVector){
+
+			t->compareBVector();
+
+		}//EOP vector defined
+
+	}//EOP compare B due
+
+	if( (t->pending & (1 << TOV1)) && (*t->mask & (1 << TOIE1)) ){
+
+		t->pending&=~(1 << TOV1);
+
+		if(t->overflowVector){
+
+			t->overflowVector();
+
+		}//EOP vector defined
+
+	}//EOP overflow due
+
+}//EOP timerTick
+
+
+//Advance ADC by one tick
+static void adcTick(double volts, double amps){
+
+	//Check ADC enabled and converting
+	if( !(ADCSRA & (1 << ADEN)) || !(ADCSRA & (1 << ADSC)) ){
+
+		adcTicks=0;
+
+		return;
+
+	}//EOP idle
+
+	if(++adcTicks<CVSLE_twinADCTicks){
+
+		return;
+
+	}//EOP converting
+
+	adcTicks=0;
+
+	//Sample selected channel
+	byte channel=(ADMUX & 0x07) | ((ADCSRB & (1 << MUX5)) ? 8 : 0);
+	double count=0;
+
+	if(channel==CVSLE_currentChannel){
+
+		count=CVSLE_currentZero+(amps/CVSLE_currentScale);
+
+	}//EOP current sensor
+	else if(channel==CVSLE_voltageChannel){
+
+		count=CVSLE_voltageZero+(volts/CVSLE_voltageScale);
+
+	}//EOP voltage sensor
+
+	ADC=(uint16_t)constrain(lround(count), 0L, 1023L);
+
+	//Single conversion clears ADSC, free running keeps it
+	if( !(ADCSRA & (1 << ADATE)) ){
+
+		ADCSRA&=~(1 << ADSC);
+
+	}//EOP single conversion
+
+	if( (ADCSRA & (1 << ADIE)) && ADC_vect ){
+
+		ADC_vect();
+
+	}//EOP vector enabled
+
+}//EOP adcTick
+
+
+//****************************
+//  Plant model
+//****************************
+
+struct TwinConfig {
+
+	double vrms; //Mains RMS volts
+	double frequency; //Mains frequency in Hz
+	double resistance; //Armature plus field resistance in ohms
+	double inductance; //Armature plus field inductance in henry
+	double motorK; //Series motor constant, back EMF = K.w.i, torque = K.i^2
+	double inertia; //Rotor and fan inertia in kg.m^2
+	double friction; //Viscous friction in N.m.s
+	double fan; //Fan load torque per (rad/s)^2
+	double seconds; //Simulated time per start
+	unsigned long loopUs; //Main loop period in microseconds
+	const char *trace; //Per half cycle trace file of the first start, or null
+
+};//EOP struct
+
+
+struct TwinResult {
+
+	byte interval;
+	byte loadMax;
+	double inrushPeak;
+	double timeToSpeed;
+	double energyWh;
+	double finalRPM;
+
+};//EOP struct
+
+
+//Plant state
+struct TwinPlant {
+
+	const TwinConfig *cfg;
+	double vpk; //Mains peak volts
+	double phaseSin; //Mains phasor
+	double phaseCos;
+	double stepCos; //Phasor rotation per tick
+	double stepSin;
+	double chunkCos; //Phasor rotation per plant chunk
+	double chunkSin;
+	double omega; //Rotor speed in rad/s
+	double current; //Motor current in amps
+	bool conducting; //Triac on
+	int direction; //Polarity the triac is conducting
+	double energy; //Energy drawn in joules
+	double peak; //Peak current of the start
+	double halfPeak; //Peak current of the running half cycle
+
+};//EOP struct
+
+
+//Load path, triac gated or bypass contactor made, through the load relay
+static bool twinGate(){
+
+#if (CVSLE_bypassMode == 1)
+	return ( (shimPinLevel[CVSLE_triacDriver] || shimPinLevel[CVSLE_bypassPin]) && shimPinLevel[CVSLE_loadRelay] );
+#else
+	return ( shimPinLevel[CVSLE_triacDriver] && shimPinLevel[CVSLE_loadRelay] );
+#endif
+
+}//EOP twinGate
+
+
+//Advance plant by dt with the given gate level, phasor turned by rotCos/rotSin
+static void plantStep(TwinPlant *p, bool gate, double dt, double rotCos, double rotSin){
+
+	//Variables
+	const TwinConfig *cfg=p->cfg;
+	double v=p->vpk*p->phaseSin;
+	double rotated=(p->phaseSin*rotCos)+(p->phaseCos*rotSin);
+
+	//Mains by phasor rotation, exact sin() only at zero-cross
+	p->phaseCos=(p->phaseCos*rotCos)-(p->phaseSin*rotSin);
+	p->phaseSin=rotated;
+
+	//Triac latches on gate with voltage across it
+	if( (!p->conducting) && gate && (fabs(v)>1.0) ){
+
+		p->conducting=true;
+		p->direction=(v>0) ? 1 : -1;
+
+	}//EOP turn on
+
+	if(p->conducting){
+
+		//Series motor, L di/dt = v - R.i - K.w.i
+		p->current+=((v-(cfg->resistance*p->current)-(cfg->motorK*p->omega*p->current))/cfg->inductance)*dt;
+
+		//Triac commutates off when current reverses without gate
+		if( (p->current*p->direction)<=0 ){
+
+			if(gate){
+
+				p->direction=-p->direction;
+
+			}//EOP gate held, conducts next polarity
+			else{
+
+				p->conducting=false;
+				p->current=0;
+
+			}//EOP turn off
+
+		}//EOP current zero
+
+		p->energy+=v*p->current*dt;
+
+		if(fabs(p->current)>p->halfPeak){
+
+			p->halfPeak=fabs(p->current);
+
+			if(p->halfPeak>p->peak){
+
+				p->peak=p->halfPeak;
+
+			}//EOP start peak
+
+		}//EOP half cycle peak
+
+	}//EOP conducting
+
+	//Mechanics, J dw/dt = K.i^2 - B.w - C.w^2
+	p->omega+=(((cfg->motorK*p->current*p->current)-(cfg->friction*p->omega)-(cfg->fan*p->omega*p->omega))/cfg->inertia)*dt;
+
+	if(p->omega<0){
+
+		p->omega=0;
+
+	}//EOP no reverse
+
+}//EOP plantStep
+
+
+//Ticks a running timer can advance before its next compare or overflow
+static uint32_t timerSlack(const TwinTimer *t){
+
+	//Variables
+	uint32_t counter=*t->counter;
+	uint32_t slack=0xFFFF-counter;
+	uint32_t toA=(uint16_t)(*t->compareA-counter-1);
+	uint32_t toB=(uint16_t)(*t->compareB-counter-1);
+
+	//Stopped timer never fires
+	if( (*t->control & 0x07)==0 ){
+
+		return 0xFFFFFFFFUL;
+
+	}//EOP stopped
+
+	if(toA<slack){
+
+		slack=toA;
+
+	}//EOP compare A first
+
+	if(toB<slack){
+
+		slack=toB;
+
+	}//EOP compare B first
+
+	return slack;
+
+}//EOP timerSlack
+
+
+//Simulate one start from standstill
+static TwinResult runStart(const TwinConfig *cfg, byte interval, byte loadMax, FILE *trace){
+
+	//Variables
+	TwinResult result;
+	TwinPlant plant;
+	double tick=CVSLE_twinTickUs*1e-6;
+	double halfPeriod=0.5/cfg->frequency;
+	double nextCross=0;
+	uint64_t crossTick=0;
+	uint64_t loopTicks=cfg->loopUs/CVSLE_twinTickUs;
+	uint64_t nextLoop=0;
+	uint64_t endTicks=(uint64_t)(cfg->seconds/tick);
+	byte timerCount=sizeof(timers)/sizeof(timers[0]);
+	std::vector<double> speedTrace;
+	std::vector<double> timeTrace;
+
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Reset registers, pins, time and plant
+	 * 2) Begin the library and apply the ramp settings
+	 * 3) On event ticks raise zero-cross, run timers, ADC and main loop
+	 * 4) Between events advance timers and plant in bulk
+	 * 5) Reduce speed trace to time to speed
+	 *
+	 */
+
+
+	//Step 1 => Reset
+	memset(shimPinLevel, 0, sizeof(shimPinLevel));
+	memset(shimPinHandler, 0, sizeof(shimPinHandler));
+	simTicks=0;
+	adcTicks=0;
+
+	for(byte i=0;i<timerCount;i++){
+
+		*timers[i].counter=0;
+		*timers[i].compareA=0;
+		*timers[i].compareB=0;
+		*timers[i].control=0;
+		*timers[i].mask=0;
+		*timers[i].flags=0;
+		timers[i].pending=0;
+
+	}//EOP timers
+
+	ADCSRA=0;
+	ADCSRB=0;
+	ADMUX=0;
+
+	if(loopTicks==0){
+
+		loopTicks=1;
+
+	}//EOP at least one tick
+
+	memset(&plant, 0, sizeof(plant));
+	plant.cfg=cfg;
+	plant.vpk=cfg->vrms*sqrt(2.0);
+	plant.phaseCos=1;
+	plant.stepCos=cos(2.0*M_PI*cfg->frequency*tick);
+	plant.stepSin=sin(2.0*M_PI*cfg->frequency*tick);
+	plant.chunkCos=cos(2.0*M_PI*cfg->frequency*tick*CVSLE_twinPlantTicks);
+	plant.chunkSin=sin(2.0*M_PI*cfg->frequency*tick*CVSLE_twinPlantTicks);
+
+
+	//Step 2 => Library
+	cvsLE.begin(CVSLE_interrupt, CVSLE_triacDriver, CVSLE_loadRelay, false);
+	cvsLE.stopLoad();
+	cvsLE.setSoftStartInterval(interval);
+	cvsLE.setLoadMax(loadMax);
+
+	result.interval=cvsLE.getSoftStartInterval();
+	result.loadMax=cvsLE.getLoadMax();
+
+
+	while(simTicks<endTicks){
+
+		//Step 3 => Event tick
+		double t=simTicks*tick;
+
+		//Zero-cross, one detector edge per half cycle
+		if(simTicks>=crossTick){
+
+			if(trace){
+
+				fprintf(trace, "%.4f,%u,%.1f,%.2f\n", t, (unsigned)OCR1A, plant.omega*60.0/(2.0*M_PI), plant.halfPeak);
+
+			}//EOP trace
+
+			timeTrace.push_back(t);
+			speedTrace.push_back(plant.omega);
+			plant.halfPeak=0;
+
+			//Pull phasor back onto the exact mains phase
+			plant.phaseSin=sin(2.0*M_PI*cfg->frequency*t);
+			plant.phaseCos=cos(2.0*M_PI*cfg->frequency*t);
+
+			nextCross+=halfPeriod;
+			crossTick=(uint64_t)ceil(nextCross/tick);
+
+			if(shimPinHandler[CVSLE_interrupt]){
+
+				shimPinHandler[CVSLE_interrupt]();
+
+			}//EOP attached
+
+		}//EOP zero-cross
+
+		//Timers and ADC
+		for(byte i=0;i<timerCount;i++){
+
+			timerTick(&timers[i]);
+
+		}//EOP timers
+
+		adcTick(plant.vpk*plant.phaseSin, plant.current);
+
+		//Plant
+		plantStep(&plant, twinGate(), tick, plant.stepCos, plant.stepSin);
+
+		//Main loop
+		if(simTicks>=nextLoop){
+
+			nextLoop+=loopTicks;
+
+			cvsLE.startLoadSoft();
+
+		}//EOP loop due
+
+		simTicks++;
+
+
+		//Step 4 => Ticks until the next event
+		uint64_t bulk=endTicks-simTicks;
+
+		if(crossTick-simTicks<bulk){
+
+			bulk=crossTick-simTicks;
+
+		}//EOP zero-cross first
+
+		if(nextLoop-simTicks<bulk){
+
+			bulk=nextLoop-simTicks;
+
+		}//EOP main loop first
+
+		for(byte i=0;i<timerCount;i++){
+
+			uint32_t slack=timerSlack(&timers[i]);
+
+			if(slack<bulk){
+
+				bulk=slack;
+
+			}//EOP timer first
+
+		}//EOP timers
+
+		if(ADCSRA & (1 << ADSC)){
+
+			bulk=0;
+
+		}//EOP ADC converting
+
+		if( (nextLoop<=simTicks) || (crossTick<=simTicks) ){
+
+			bulk=0;
+
+		}//EOP event due now
+
+		//Nothing switches inside the bulk, timers move without events
+		for(byte i=0;i<timerCount;i++){
+
+			if(*timers[i].control & 0x07){
+
+				*timers[i].counter+=bulk;
+
+			}//EOP running
+
+		}//EOP timers
+
+		bool gate=twinGate();
+
+		if( (!plant.conducting) && (!gate) ){
+
+			//Idle motor coasts, one step covers the bulk
+			plantStep(&plant, false, bulk*tick, 1, 0);
+
+			double tb=(simTicks+bulk)*tick;
+
+			plant.phaseSin=sin(2.0*M_PI*cfg->frequency*tb);
+			plant.phaseCos=cos(2.0*M_PI*cfg->frequency*tb);
+
+		}//EOP idle
+		else{
+
+			uint64_t k=0;
+
+			while(k<bulk){
+
+				//Once latched the gate cannot change inside the bulk, coarser steps hold
+				if( plant.conducting && ((k+CVSLE_twinPlantTicks)<=bulk) ){
+
+					plantStep(&plant, gate, tick*CVSLE_twinPlantTicks, plant.chunkCos, plant.chunkSin);
+					k+=CVSLE_twinPlantTicks;
+
+				}//EOP chunk
+				else{
+
+					plantStep(&plant, gate, tick, plant.stepCos, plant.stepSin);
+					k++;
+
+				}//EOP tick
+
+			}//EOP bulk
+
+		}//EOP conducting
+
+		simTicks+=bulk;
+
+	}//EOP ticks
+
+
+	//Step 5 => Time to speed
+	result.inrushPeak=plant.peak;
+	result.energyWh=plant.energy/3600.0;
+	result.finalRPM=plant.omega*60.0/(2.0*M_PI);
+	result.timeToSpeed=-1;
+
+	for(size_t i=0;i<speedTrace.size();i++){
+
+		if( (plant.omega>0) && (speedTrace[i]>=(CVSLE_twinSpeedBand*plant.omega)) ){
+
+			result.timeToSpeed=timeTrace[i];
+
+			break;
+
+		}//EOP in band
+
+	}//EOP trace
+
+	cvsLE.stopLoad();
+
+	return result;
+
+}//EOP runStart
+
+
+//Parse comma list of byte values
+static byte parseList(const char *text, byte *values){
+
+	//Variables
+	byte count=0;
+	char buffer[256];
+	char *token;
+
+	strncpy(buffer, text, sizeof(buffer)-1);
+	buffer[sizeof(buffer)-1]=0;
+
+	for(token=strtok(buffer, ",");token && (count<CVSLE_twinListMax);token=strtok(0, ",")){
+
+		values[count++]=(byte)atoi(token);
+
+	}//EOP tokens
+
+	return count;
+
+}//EOP parseList
+
+
+static void usage(){
+
+	printf("digitalTwin [options]\n");
+	printf("  -i list   soft start intervals in s, e.g. 5,10,20 (default %d)\n", CVSLE_softStartInterval);
+	printf("  -m list   load max in %%, e.g. 60,80,100 (default %d)\n", CVSLE_loadMaxPercent);
+	printf("  -t s      simulated seconds per start (default interval + 10)\n");
+	printf("  -v V      mains RMS volts (230)\n");
+	printf("  -f Hz     mains frequency (50)\n");
+	printf("  -R ohm    motor resistance (2.0)\n");
+	printf("  -L H      motor inductance (0.03)\n");
+	printf("  -K k      series motor constant (0.01)\n");
+	printf("  -J kgm2   rotor and fan inertia (0.0002)\n");
+	printf("  -B Nms    viscous friction (0.00001)\n");
+	printf("  -C k      fan torque per (rad/s)^2 (0.000000025)\n");
+	printf("  -l us     main loop period (1000)\n");
+	printf("  -trace f  write per half cycle trace of the first start to f\n");
+
+}//EOP usage
+
+
+int main(int argc, char **argv){
+
+	//Variables
+	TwinConfig cfg={ 230.0, 50.0, 2.0, 0.03, 0.01, 0.0002, 0.00001, 0.000000025, 0, 1000, 0 };
+	byte intervals[CVSLE_twinListMax]={ CVSLE_softStartInterval };
+	byte loads[CVSLE_twinListMax]={ CVSLE_loadMaxPercent };
+	byte intervalCount=1;
+	byte loadCount=1;
+	double seconds=0;
+	double simulated=0;
+	clock_t started=clock();
+	FILE *trace=0;
+
+
+	//Step 1 => Options
+	for(int a=1;a<argc;a++){
+
+		const char *opt=argv[a];
+		const char *val=(a+1<argc) ? argv[a+1] : 0;
+
+		if(!strcmp(opt, "-help") || !strcmp(opt, "-h") || !val){
+
+			usage();
+
+			return (!strcmp(opt, "-help") || !strcmp(opt, "-h")) ? 0 : 1;
+
+		}//EOP help or missing value
+
+		a++;
+
+		if(!strcmp(opt, "-i")){ intervalCount=parseList(val, intervals); }
+		else if(!strcmp(opt, "-m")){ loadCount=parseList(val, loads); }
+		else if(!strcmp(opt, "-t")){ seconds=atof(val); }
+		else if(!strcmp(opt, "-v")){ cfg.vrms=atof(val); }
+		else if(!strcmp(opt, "-f")){ cfg.frequency=atof(val); }
+		else if(!strcmp(opt, "-R")){ cfg.resistance=atof(val); }
+		else if(!strcmp(opt, "-L")){ cfg.inductance=atof(val); }
+		else if(!strcmp(opt, "-K")){ cfg.motorK=atof(val); }
+		else if(!strcmp(opt, "-J")){ cfg.inertia=atof(val); }
+		else if(!strcmp(opt, "-B")){ cfg.friction=atof(val); }
+		else if(!strcmp(opt, "-C")){ cfg.fan=atof(val); }
+		else if(!strcmp(opt, "-l")){ cfg.loopUs=strtoul(val, 0, 10); }
+		else if(!strcmp(opt, "-trace")){ cfg.trace=val; }
+		else{
+
+			usage();
+
+			return 1;
+
+		}//EOP unknown option
+
+	}//EOP options
+
+	if(cfg.trace){
+
+		trace=fopen(cfg.trace, "w");
+
+		if(!trace){
+
+			fprintf(stderr, "cannot open %s\n", cfg.trace);
+
+			return 1;
+
+		}//EOP open failed
+
+		fprintf(trace, "time_s,compare,speed_rpm,half_cycle_peak_a\n");
+
+	}//EOP trace
+
+
+	//Step 2 => Batch
+	printf("interval_s,load_max_pct,inrush_peak_a,time_to_speed_s,energy_wh,final_rpm\n");
+
+	for(byte i=0;i<intervalCount;i++){
+
+		for(byte m=0;m<loadCount;m++){
+
+			cfg.seconds=(seconds>0) ? seconds : (intervals[i]+10.0);
+
+			TwinResult r=runStart(&cfg, intervals[i], loads[m], trace);
+
+			printf("%u,%u,%.2f,%.3f,%.3f,%.0f\n", r.interval, r.loadMax, r.inrushPeak, r.timeToSpeed, r.energyWh, r.finalRPM);
+
+			simulated+=cfg.seconds;
+
+			if(trace){
+
+				fclose(trace);
+				trace=0;
+
+			}//EOP first start only
+
+		}//EOP loads
+
+	}//EOP intervals
+
+
+	//Step 3 => Speed report
+	double hostSecs=(double)(clock()-started)/CLOCKS_PER_SEC;
+
+	fprintf(stderr, "simulated %.0f s in %.2f s, %.0fx real time\n", simulated, hostSecs, (hostSecs>0) ? (simulated/hostSecs) : 0.0);
+
+	return 0;
+
+}//EOP main
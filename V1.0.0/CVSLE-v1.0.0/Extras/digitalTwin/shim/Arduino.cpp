@@ -0,0 +1,124 @@
+/*
+ * Arduino.cpp
+ *
+ *
+ * Host shim state shared by the digital twin, the stagger bus stand-in and
+ * the Modbus loopback: the ATmega2560 registers of avr/io.h, Serial, digital
+ * pins, interrupt attach and random. Pins only keep their level, a host program that
+ * simulates pin changes reads shimPinLevel and calls shimPinHandler itself.
+ * Time is served by the host program, it defines millis() and micros().
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include "Arduino.h"
+
+
+//****************************
+//  Registers
+//****************************
+
+#define CVSLE_SHIM_TIMER_DEF(n) \
+	volatile uint16_t TCNT##n; \
+	volatile uint16_t OCR##n##A; \
+	volatile uint16_t OCR##n##B; \
+	volatile uint16_t ICR##n; \
+	volatile uint8_t TCCR##n##A; \
+	volatile uint8_t TCCR##n##B; \
+	volatile uint8_t TIMSK##n; \
+	volatile uint8_t TIFR##n;
+
+CVSLE_SHIM_TIMER_DEF(1)
+CVSLE_SHIM_TIMER_DEF(3)
+CVSLE_SHIM_TIMER_DEF(4)
+CVSLE_SHIM_TIMER_DEF(5)
+
+volatile uint8_t ADCSRA;
+volatile uint8_t ADCSRB;
+volatile uint8_t ADMUX;
+volatile uint16_t ADC;
+volatile uint8_t SREG;
+volatile uint8_t MCUSR;
+
+volatile uint8_t shimUDR[4];
+volatile uint8_t shimUCSRA[4];
+volatile uint8_t shimUCSRB[4];
+volatile uint8_t shimUCSRC[4];
+volatile uint16_t shimUBRR[4];
+
+Print Serial;
+
+
+//****************************
+//  Pins and interrupts
+//****************************
+
+uint8_t shimPinLevel[CVSLE_shimPins];
+void (*shimPinHandler[CVSLE_shimPins])();
+
+
+void pinMode(uint8_t, uint8_t){
+
+}//EOP pinMode
+
+
+void digitalWrite(uint8_t pin, uint8_t val){
+
+	if(pin<CVSLE_shimPins){
+
+		shimPinLevel[pin]=(val!=LOW);
+
+	}//EOP valid pin
+
+}//EOP digitalWrite
+
+
+int digitalRead(uint8_t pin){
+
+	return (pin<CVSLE_shimPins) ? shimPinLevel[pin] : LOW;
+
+}//EOP digitalRead
+
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int){
+
+	if(interruptNum<CVSLE_shimPins){
+
+		shimPinHandler[interruptNum]=userFunc;
+
+	}//EOP valid pin
+
+}//EOP attachInterrupt
+
+
+void detachInterrupt(uint8_t interruptNum){
+
+	if(interruptNum<CVSLE_shimPins){
+
+		shimPinHandler[interruptNum]=0;
+
+	}//EOP valid pin
+
+}//EOP detachInterrupt
+
+
+//****************************
+//  Random
+//****************************
+
+long random(long howbig){
+
+	return (howbig>0) ? (rand()%howbig) : 0;
+
+}//EOP random
+
+
+void randomSeed(unsigned long seed){
+
+	srand((unsigned int)seed);
+
+}//EOP randomSeed
@@ -0,0 +1,102 @@
+/*
+ * Arduino.h
+ *
+ *
+ * Host shim of the Arduino core calls CVSLE uses, for the digital twin, the
+ * stagger bus stand-in and the Modbus loopback. Pins, random and interrupt
+ * attach are served by Arduino.cpp next to this header, time by the host
+ * program, digitalTwin.cpp, staggerBus.cpp or modbusLoopback.cpp.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef ARDUINO_SHIM_H_
+#define ARDUINO_SHIM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define digitalPinToInterrupt(p) (p)
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+//Pin state for the host program
+#define CVSLE_shimPins 70 //Simulated digital pins
+
+extern uint8_t shimPinLevel[CVSLE_shimPins];
+extern void (*shimPinHandler[CVSLE_shimPins])();
+
+long random(long howbig);
+void randomSeed(unsigned long seed);
+
+//ISRs are run between main loop steps, nothing to mask
+#define noInterrupts()
+#define interrupts()
+
+
+//Print to stdout, enough for CVSLERecorder::dump
+class Print {
+
+public:
+
+	size_t print(const char *s){ return printf("%s", s); }
+	size_t print(char c){ return printf("%c", c); }
+	size_t print(long v){ return printf("%ld", v); }
+	size_t print(unsigned long v){ return printf("%lu", v); }
+	size_t print(int v){ return printf("%d", v); }
+	size_t print(unsigned int v){ return printf("%u", v); }
+	size_t println(){ return printf("\n"); }
+	template <typename T> size_t println(T v){ return print(v)+println(); }
+
+};//EOP class
+
+extern Print Serial;
+
+
+//Byte stream, the host program supplies the transport
+class Stream : public Print {
+
+public:
+
+	virtual int available()=0;
+	virtual int read()=0;
+	virtual size_t write(const uint8_t *buffer, size_t size)=0;
+	virtual void flush()=0;
+
+};//EOP class
+
+
+#endif /* ARDUINO_SHIM_H_ */
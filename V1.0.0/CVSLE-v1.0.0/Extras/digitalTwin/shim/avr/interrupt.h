@@ -0,0 +1,23 @@
+/*
+ * interrupt.h
+ *
+ *
+ * Host shim of avr/interrupt.h for the digital twin. Each ISR becomes a
+ * plain C function named after its vector, called by the simulator.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef AVR_INTERRUPT_SHIM_H_
+#define AVR_INTERRUPT_SHIM_H_
+
+#define ISR(vector) extern "C" void vector(void); extern "C" void vector(void)
+
+#define cli()
+#define sei()
+
+#endif /* AVR_INTERRUPT_SHIM_H_ */
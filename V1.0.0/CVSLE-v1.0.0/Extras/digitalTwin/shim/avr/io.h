@@ -0,0 +1,116 @@
+/*
+ * io.h
+ *
+ *
+ * Host shim of the ATmega2560 registers CVSLE touches, for the digital
+ * twin and the other host programs. Registers are plain variables defined
+ * in shim/Arduino.cpp, the host program reads and advances them between
+ * main loop steps. USART registers are macros over arrays, so the
+ * defined(UDRn) checks of the library see USART0 to USART3.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#ifndef AVR_IO_SHIM_H_
+#define AVR_IO_SHIM_H_
+
+#include <stdint.h>
+
+#define F_CPU 16000000UL
+
+//16 bit timers
+#define CVSLE_SHIM_TIMER(n) \
+	extern volatile uint16_t TCNT##n; \
+	extern volatile uint16_t OCR##n##A; \
+	extern volatile uint16_t OCR##n##B; \
+	extern volatile uint16_t ICR##n; \
+	extern volatile uint8_t TCCR##n##A; \
+	extern volatile uint8_t TCCR##n##B; \
+	extern volatile uint8_t TIMSK##n; \
+	extern volatile uint8_t TIFR##n;
+
+CVSLE_SHIM_TIMER(1)
+CVSLE_SHIM_TIMER(3)
+CVSLE_SHIM_TIMER(4)
+CVSLE_SHIM_TIMER(5)
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+
+//ADC
+extern volatile uint8_t ADCSRA;
+extern volatile uint8_t ADCSRB;
+extern volatile uint8_t ADMUX;
+extern volatile uint16_t ADC;
+
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define MUX5 3
+#define REFS0 6
+
+//USARTs, macros as on the part so defined(UDRn) finds them
+extern volatile uint8_t shimUDR[4];
+extern volatile uint8_t shimUCSRA[4];
+extern volatile uint8_t shimUCSRB[4];
+extern volatile uint8_t shimUCSRC[4];
+extern volatile uint16_t shimUBRR[4];
+
+#define UDR0 (shimUDR[0])
+#define UDR1 (shimUDR[1])
+#define UDR2 (shimUDR[2])
+#define UDR3 (shimUDR[3])
+#define UCSR0A (shimUCSRA[0])
+#define UCSR1A (shimUCSRA[1])
+#define UCSR2A (shimUCSRA[2])
+#define UCSR3A (shimUCSRA[3])
+#define UCSR0B (shimUCSRB[0])
+#define UCSR1B (shimUCSRB[1])
+#define UCSR2B (shimUCSRB[2])
+#define UCSR3B (shimUCSRB[3])
+#define UCSR0C (shimUCSRC[0])
+#define UCSR1C (shimUCSRC[1])
+#define UCSR2C (shimUCSRC[2])
+#define UCSR3C (shimUCSRC[3])
+#define UBRR0 (shimUBRR[0])
+#define UBRR1 (shimUBRR[1])
+#define UBRR2 (shimUBRR[2])
+#define UBRR3 (shimUBRR[3])
+
+#define U2X0 1
+#define UCSZ00 1
+#define UCSZ01 2
+#define TXC0 6
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+
+//Status and reset flags
+extern volatile uint8_t SREG;
+extern volatile uint8_t MCUSR;
+
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+
+#endif /* AVR_IO_SHIM_H_ */
@@ -0,0 +1,505 @@
+/*
+ * modbusLoopback.cpp
+ *
+ *
+ * Host loopback for CVSLEModbus. The real CVSLE.cpp and CVSLEModbus.cpp run
+ * against the shim headers of Extras/digitalTwin, this program is the RS-485
+ * line and a Modbus master. Request bytes reach the slave's receive ISR one
+ * character time apart, the slave's reply is clocked out of its data
+ * register empty and transmit complete ISRs and echoed back into its own
+ * receiver, as on a half duplex line. poll() runs like a busy loop(), or is
+ * held off until a whole burst of frames is in the buffer.
+ *
+ * Every case sends one or more requests and compares the reply byte for
+ * byte, CRC included. Covered are function 03, 04, 06 and 16, the
+ * exception replies, writes refused while the load runs, CRC errors and
+ * frames sent back to back before poll() gets to them.
+ *
+ * Build:  g++ -O2 -I../digitalTwin/shim -I../.. -o modbusLoopback modbusLoopback.cpp ../digitalTwin/shim/Arduino.cpp ../../CVSLE.cpp ../../CVSLEModbus.cpp
+ * Use:    ./modbusLoopback
+ *
+ * CVSLE_modbusMode must be set to 1 in CVSLEModbus.h. Exit status is 0 when
+ * every case passed.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "CVSLE.h"
+#include "CVSLEModbus.h"
+
+#if (CVSLE_modbusMode == 0)
+#error "Set CVSLE_modbusMode to 1 in CVSLEModbus.h to build modbusLoopback"
+#endif
+
+#if (CVSLE_modbusUSART < 1) || (CVSLE_modbusUSART > 3)
+#error "modbusLoopback drives USART1 to USART3, set CVSLE_modbusUSART to one of them"
+#endif
+
+#define CVSLE_loopSlaveID 1 //Slave address under test
+#define CVSLE_loopBaud 19200 //Line speed
+#define CVSLE_loopDEPin 4 //Driver enable pin
+#define CVSLE_loopCharUs ((11UL*1000000UL)/CVSLE_loopBaud) //One character on the line
+#define CVSLE_loopPollUs 100 //poll() period of a busy loop()
+#define CVSLE_loopReplyUs 50000 //Max wait for a reply after the last request byte
+#define CVSLE_loopLine 128 //Max bytes queued by the master
+
+
+//****************************
+//  Shim time and USART
+//****************************
+
+#define CVSLE_LOOP_VECTORS_(n) \
+	extern "C" void USART##n##_RX_vect(void); \
+	extern "C" void USART##n##_UDRE_vect(void); \
+	extern "C" void USART##n##_TX_vect(void); \
+	static void (*const rxVector)(void)=USART##n##_RX_vect; \
+	static void (*const udreVector)(void)=USART##n##_UDRE_vect; \
+	static void (*const txVector)(void)=USART##n##_TX_vect;
+
+#define CVSLE_LOOP_VECTORS(n) CVSLE_LOOP_VECTORS_(n)
+
+CVSLE_LOOP_VECTORS(CVSLE_modbusUSART)
+
+static uint64_t simUs;
+
+
+unsigned long millis(){
+
+	return (unsigned long)(simUs/1000);
+
+}//EOP millis
+
+
+unsigned long micros(){
+
+	return (unsigned long)simUs;
+
+}//EOP micros
+
+
+//****************************
+//  Line model
+//****************************
+
+static uint8_t masterByte[CVSLE_loopLine];
+static uint64_t masterAt[CVSLE_loopLine];
+static int masterLength;
+static int masterIndex;
+
+static bool shifting;
+static uint8_t shiftByte;
+static uint64_t shiftDone;
+
+static uint8_t reply[CVSLE_loopLine];
+static int replyLength;
+static bool replyDone;
+static bool deSeen;
+
+
+//Modbus CRC, bitwise, independent of the library's
+static uint16_t crc16(const uint8_t *data, int length){
+
+	//Variables
+	uint16_t crc=0xFFFF;
+
+	for(int i=0;i<length;i++){
+
+		crc^=data[i];
+
+		for(int b=0;b<8;b++){
+
+			crc=(crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+
+		}//EOP bits
+
+	}//EOP bytes
+
+	return crc;
+
+}//EOP crc16
+
+
+//Byte arrives at the slave receiver
+static void lineDeliver(uint8_t data){
+
+	shimUDR[CVSLE_modbusUSART]=data;
+	rxVector();
+
+}//EOP lineDeliver
+
+
+//Queue a request after gapChars of silence, CRC appended unless corrupt
+static void masterQueue(const uint8_t *frame, int length, int gapChars, bool corrupt=false){
+
+	//Variables
+	uint8_t line[CVSLE_loopLine];
+	uint16_t crc=crc16(frame, length);
+	uint64_t at=simUs+CVSLE_loopCharUs;
+
+	memcpy(line, frame, length);
+	line[length]=crc & 0xFF;
+	line[length+1]=(crc >> 8) ^ (corrupt ? 0x01 : 0x00);
+	length+=2;
+
+	if( (masterLength>0) && ((masterAt[masterLength-1]+(gapChars*CVSLE_loopCharUs))>at) ){
+
+		at=masterAt[masterLength-1]+(gapChars*CVSLE_loopCharUs);
+
+	}//EOP after previous frame
+
+	for(int i=0;i<length;i++){
+
+		masterByte[masterLength]=line[i];
+		masterAt[masterLength]=at+(i*CVSLE_loopCharUs);
+		masterLength++;
+
+	}//EOP bytes
+
+}//EOP masterQueue
+
+
+//Advance the line by one microSec
+static void lineStep(bool pollHeld){
+
+	simUs++;
+
+	//Master drives the line
+	if( (masterIndex<masterLength) && (simUs>=masterAt[masterIndex]) ){
+
+		lineDeliver(masterByte[masterIndex]);
+		masterIndex++;
+
+	}//EOP master byte
+
+	//Slave shift register, own bytes come back on the receiver
+	if( shifting && (simUs>=shiftDone) ){
+
+		shifting=false;
+
+		if(replyLength<CVSLE_loopLine){
+
+			reply[replyLength]=shiftByte;
+			replyLength++;
+
+		}//EOP room
+
+		lineDeliver(shiftByte);
+
+		if( !(shimUCSRB[CVSLE_modbusUSART] & (1 << UDRIE0)) && (shimUCSRB[CVSLE_modbusUSART] & (1 << TXCIE0)) ){
+
+			shimUCSRA[CVSLE_modbusUSART]|=(1 << TXC0);
+			txVector();
+			replyDone=true;
+
+		}//EOP last byte out
+
+	}//EOP byte out
+
+	if( !shifting && (shimUCSRB[CVSLE_modbusUSART] & (1 << UDRIE0)) ){
+
+		udreVector();
+
+		shiftByte=shimUDR[CVSLE_modbusUSART];
+		shiftDone=simUs+CVSLE_loopCharUs;
+		shifting=true;
+		deSeen=deSeen || shimPinLevel[CVSLE_loopDEPin];
+
+	}//EOP data register empty
+
+	//Main loop
+	if( (simUs%CVSLE_loopPollUs)==0 ){
+
+		if( !pollHeld || (masterIndex>=masterLength) ){
+
+			cvsModbus.poll();
+
+		}//EOP poll
+
+	}//EOP loop turn
+
+}//EOP lineStep
+
+
+//Run the queued requests and collect the reply
+static void lineRun(bool pollHeld){
+
+	//Variables
+	uint64_t until=0;
+
+	replyLength=0;
+	replyDone=false;
+	deSeen=false;
+
+	while( (masterIndex<masterLength) || shifting ){
+
+		lineStep(pollHeld);
+
+	}//EOP sending
+
+	until=simUs+CVSLE_loopReplyUs;
+
+	while( (simUs<until) && !replyDone ){
+
+		lineStep(pollHeld);
+
+	}//EOP waiting
+
+	//Let the bus go quiet before the next case
+	until=simUs+(8*CVSLE_loopCharUs);
+
+	while(simUs<until){
+
+		lineStep(pollHeld);
+
+	}//EOP settle
+
+	masterLength=0;
+	masterIndex=0;
+
+}//EOP lineRun
+
+
+//****************************
+//  Cases
+//****************************
+
+static int casesRun;
+static int casesFailed;
+
+
+//Compare reply without its CRC, a null expect means no reply
+static void check(const char *name, const uint8_t *expect, int expectLength){
+
+	//Variables
+	bool pass=true;
+
+	casesRun++;
+
+	if(expect==0){
+
+		pass=(replyLength==0);
+
+	}//EOP silence expected
+	else if( (replyLength!=(expectLength+2)) || memcmp(reply, expect, expectLength) ){
+
+		pass=false;
+
+	}//EOP wrong reply
+	else{
+
+		uint16_t crc=crc16(reply, expectLength);
+
+		pass=( (reply[expectLength]==(crc & 0xFF)) && (reply[expectLength+1]==(crc >> 8)) && deSeen && !shimPinLevel[CVSLE_loopDEPin] );
+
+	}//EOP reply CRC and driver enable
+
+	if(!pass){
+
+		casesFailed++;
+
+	}//EOP failed
+
+	printf("%s %s", pass ? "PASS" : "FAIL", name);
+
+	if(!pass){
+
+		printf(", got");
+
+		for(int i=0;i<replyLength;i++){
+
+			printf(" %02X", reply[i]);
+
+		}//EOP bytes
+
+	}//EOP show reply
+
+	printf("\n");
+
+}//EOP check
+
+
+//One request, one expected reply
+static void transact(const char *name, const uint8_t *request, int requestLength, const uint8_t *expect, int expectLength){
+
+	masterQueue(request, requestLength, 4);
+	lineRun(false);
+	check(name, expect, expectLength);
+
+}//EOP transact
+
+
+#define CVSLE_LOOP_CASE(name, request, expect) transact(name, request, sizeof(request), expect, sizeof(expect))
+
+
+int main(){
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Begin library and slave like setup()
+	 * 2) Reads and writes with the load stopped
+	 * 3) Exception replies
+	 * 4) Writes while the load runs
+	 * 5) CRC error and back to back frames
+	 *
+	 */
+
+
+	//Step 1 => Setup
+	cvsLE.begin(18, 5, 6, false);
+
+	if(!cvsModbus.begin(CVSLE_loopSlaveID, CVSLE_loopBaud, CVSLE_loopDEPin)){
+
+		printf("FAIL begin\n");
+
+		return 1;
+
+	}//EOP no USART
+
+	//Step 2 => Load stopped
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x00, 0x00, 0x50 };
+		const uint8_t expect[]={ 0x01, 0x06, 0x00, 0x00, 0x00, 0x50 };
+		CVSLE_LOOP_CASE("FC06 write load max 80", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x01, 0x00, 0x0C };
+		const uint8_t expect[]={ 0x01, 0x06, 0x00, 0x01, 0x00, 0x0C };
+		CVSLE_LOOP_CASE("FC06 write soft start 12", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x00, 0x00, 0x02 };
+		const uint8_t expect[]={ 0x01, 0x03, 0x04, 0x00, 0x50, 0x00, 0x0C };
+		CVSLE_LOOP_CASE("FC03 read back 80, 12", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0x00, 0x46, 0x00, 0x0F };
+		const uint8_t expect[]={ 0x01, 0x10, 0x00, 0x00, 0x00, 0x02 };
+		CVSLE_LOOP_CASE("FC16 write 70, 15", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x04, 0x00, 0x00, 0x00, 0x02 };
+		const uint8_t expect[]={ 0x01, 0x04, 0x04, 0x00, 0x46, 0x00, 0x0F };
+		CVSLE_LOOP_CASE("FC04 read back 70, 15", request, expect);
+	}
+
+	//Step 3 => Exceptions
+	{
+		const uint8_t request[]={ 0x01, 0x05, 0x00, 0x00, 0xFF, 0x00 };
+		const uint8_t expect[]={ 0x01, 0x85, CVSLE_modbusIllegalFunction };
+		CVSLE_LOOP_CASE("FC05 illegal function", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x04, 0x00, 0x02 };
+		const uint8_t expect[]={ 0x01, 0x83, CVSLE_modbusIllegalAddress };
+		CVSLE_LOOP_CASE("FC03 past last register", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x00, 0x00, 0x00 };
+		const uint8_t expect[]={ 0x01, 0x83, CVSLE_modbusIllegalValue };
+		CVSLE_LOOP_CASE("FC03 quantity 0", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x00, 0x01, 0x2C };
+		const uint8_t expect[]={ 0x01, 0x86, CVSLE_modbusIllegalValue };
+		CVSLE_LOOP_CASE("FC06 load max 300", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x03, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x86, CVSLE_modbusIllegalAddress };
+		CVSLE_LOOP_CASE("FC06 read only frequency", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x10, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x46 };
+		const uint8_t expect[]={ 0x01, 0x90, CVSLE_modbusIllegalValue };
+		CVSLE_LOOP_CASE("FC16 byte count short", request, expect);
+	}
+
+	//Step 4 => Load running
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x02, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x06, 0x00, 0x02, 0x00, 0x01 };
+		CVSLE_LOOP_CASE("FC06 run", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x04, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x03, 0x02, 0x00, 0x01 };
+		CVSLE_LOOP_CASE("FC03 state running", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x00, 0x00, 0x3C };
+		const uint8_t expect[]={ 0x01, 0x86, CVSLE_modbusSlaveFailure };
+		CVSLE_LOOP_CASE("FC06 load max while running", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0x00, 0x3C, 0x00, 0x0A };
+		const uint8_t expect[]={ 0x01, 0x90, CVSLE_modbusSlaveFailure };
+		CVSLE_LOOP_CASE("FC16 settings while running", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x06, 0x00, 0x02, 0x00, 0x00 };
+		const uint8_t expect[]={ 0x01, 0x06, 0x00, 0x02, 0x00, 0x00 };
+		CVSLE_LOOP_CASE("FC06 stop", request, expect);
+	}
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x00, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x03, 0x02, 0x00, 0x46 };
+		CVSLE_LOOP_CASE("FC03 load max kept 70", request, expect);
+	}
+
+	//Step 5 => Line errors and bursts
+	{
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x00, 0x00, 0x01 };
+		uint16_t errors=cvsModbus.getErrorCount();
+
+		masterQueue(request, sizeof(request), 4, true);
+		lineRun(false);
+		check("CRC error ignored", 0, 0);
+
+		casesRun++;
+
+		if(cvsModbus.getErrorCount()!=(errors+1)){
+
+			casesFailed++;
+			printf("FAIL CRC error counted\n");
+
+		}//EOP not counted
+		else{
+
+			printf("PASS CRC error counted\n");
+
+		}//EOP counted
+	}
+	{
+		const uint8_t other[]={ 0x02, 0x03, 0x00, 0x00, 0x00, 0x05 };
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x01, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x03, 0x02, 0x00, 0x0F };
+
+		masterQueue(other, sizeof(other), 4);
+		masterQueue(request, sizeof(request), 4);
+		lineRun(true);
+		check("other slave then own frame, late poll", expect, sizeof(expect));
+	}
+	{
+		const uint8_t broadcast[]={ 0x00, 0x06, 0x00, 0x00, 0x00, 0x5A };
+		const uint8_t request[]={ 0x01, 0x03, 0x00, 0x00, 0x00, 0x01 };
+		const uint8_t expect[]={ 0x01, 0x03, 0x02, 0x00, 0x5A };
+
+		masterQueue(broadcast, sizeof(broadcast), 4);
+		masterQueue(request, sizeof(request), 4);
+		lineRun(true);
+		check("broadcast write then read, late poll", expect, sizeof(expect));
+	}
+
+	printf("%d of %d cases passed: %s\n", casesRun-casesFailed, casesRun, (casesFailed==0) ? "PASS" : "FAIL");
+
+	//Return
+	return (casesFailed==0) ? 0 : 1;
+
+}//EOP main
@@ -0,0 +1,592 @@
+/*
+ * staggerBus.cpp
+ *
+ *
+ * Host stand-in for a shared RS-485 line, for testing CVSLEStagger. One
+ * process per unit runs the real CVSLE.cpp and CVSLEStagger.cpp against the
+ * shim headers of Extras/digitalTwin. All units request a start at once, as
+ * after a power restore. The parent process is the bus: it repeats every
+ * byte to all units including the sender, and garbles frames whose air time
+ * overlaps, like two drivers fighting on the line.
+ *
+ * The parent logs ramp start, load max and back off of every unit and
+ * checks that no more than CVSLE_staggerConcurrent ramps ever overlap.
+ * Time runs -x times faster than real time in all processes.
+ *
+ * Build:  g++ -O2 -I../digitalTwin/shim -I../.. -o staggerBus staggerBus.cpp ../digitalTwin/shim/Arduino.cpp ../../CVSLE.cpp ../../CVSLEStagger.cpp
+ * Use:    ./staggerBus -n 8 -i 5
+ *         ./staggerBus -help
+ *
+ * CVSLE_staggerMode must be set to 1 in CVSLEStagger.h. Exit status is 0
+ * when every unit reached load max without exceeding the site limit.
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "CVSLE.h"
+#include "CVSLEStagger.h"
+
+#if (CVSLE_staggerMode == 0)
+#error "Set CVSLE_staggerMode to 1 in CVSLEStagger.h to build staggerBus"
+#endif
+
+#define CVSLE_busUnitsMax CVSLE_staggerUnits //Max simulated units
+#define CVSLE_busBuffer 64 //Bytes in flight on the line
+#define CVSLE_busHoldMs 500 //Units keep polling this long after load max
+
+//Unit events sent to the parent
+#define CVSLE_busRamp 'R' //Slot granted, ramp started
+#define CVSLE_busFull 'F' //Load max reached, slot released
+#define CVSLE_busYield 'Y' //Double granted ramp stopped
+#define CVSLE_busExit 'X' //Unit finished, value is collision count
+
+
+//****************************
+//  Shim time
+//****************************
+
+static struct timespec epoch;
+static double speed=10.0;
+
+
+//Real time since epoch scaled by speed, in microSecs
+static uint64_t simMicros(){
+
+	//Variables
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	double us=((now.tv_sec-epoch.tv_sec)*1e6)+((now.tv_nsec-epoch.tv_nsec)/1e3);
+
+	return (uint64_t)(us*speed);
+
+}//EOP simMicros
+
+
+unsigned long millis(){
+
+	return (unsigned long)(simMicros()/1000);
+
+}//EOP millis
+
+
+unsigned long micros(){
+
+	return (unsigned long)simMicros();
+
+}//EOP micros
+
+
+//Unit end of the line, a socket to the parent
+class BusStream : public Stream {
+
+public:
+
+	int fd;
+
+	int available(){
+
+		int count=0;
+
+		ioctl(fd, FIONREAD, &count);
+
+		return count;
+
+	}//EOP available
+
+	int read(){
+
+		uint8_t data;
+
+		return (recv(fd, &data, 1, MSG_DONTWAIT)==1) ? data : -1;
+
+	}//EOP read
+
+	size_t write(const uint8_t *buffer, size_t size){
+
+		return send(fd, buffer, size, 0);
+
+	}//EOP write
+
+	void flush(){
+
+	}//EOP flush
+
+};//EOP class
+
+
+//Event record from a unit to the parent, one atomic pipe write
+struct BusEvent {
+
+	uint8_t unit;
+	char type;
+	uint16_t value;
+	uint32_t ms;
+
+};//EOP struct
+
+
+//****************************
+//  Unit process
+//****************************
+
+static void report(int fd, byte unit, char type, uint16_t value){
+
+	//Variables
+	BusEvent event={ unit, type, value, (uint32_t)millis() };
+
+	if(::write(fd, &event, sizeof(event))<0){
+
+		_exit(2);
+
+	}//EOP parent gone
+
+}//EOP report
+
+
+static void runUnit(byte unit, int busFd, int eventFd, byte interval, unsigned long jitterMs, unsigned long timeoutMs){
+
+	//Variables
+	BusStream bus;
+	byte lastState=CVSLE_staggerIdle;
+	unsigned long fullAt=0;
+
+	bus.fd=busFd;
+
+
+	/*
+	 * The following steps are undertaken:
+	 * 1) Wait for the bus, then begin library and coordinator like setup()
+	 * 2) Request a start after the power restore jitter
+	 * 3) Poll like loop() and report state changes until done
+	 *
+	 */
+
+
+	//Step 1 => Power on together once the bus runs
+	uint8_t go;
+
+	if(recv(busFd, &go, 1, 0)!=1){
+
+		_exit(2);
+
+	}//EOP bus gone
+
+	clock_gettime(CLOCK_MONOTONIC, &epoch);
+
+	cvsLE.begin(CVSLE_interrupt, CVSLE_triacDriver, CVSLE_loadRelay, false);
+	cvsLE.setSoftStartInterval(interval);
+	cvsStagger.begin(bus, unit);
+
+	//Step 2 => Power restore
+	srand(unit*7919+getpid());
+	unsigned long requestAt=(jitterMs>0) ? (unsigned long)(rand()%jitterMs) : 0;
+
+	while(millis()<requestAt){
+
+		usleep(100);
+
+	}//EOP jitter
+
+	cvsStagger.requestStart();
+
+
+	//Step 3 => Loop
+	while(millis()<timeoutMs){
+
+		cvsStagger.poll();
+
+		byte state=cvsStagger.getState();
+
+		if(state!=lastState){
+
+			if(state==CVSLE_staggerRamp){
+
+				report(eventFd, unit, CVSLE_busRamp, 0);
+
+			}//EOP granted
+			else if( (state==CVSLE_staggerRun) && (lastState==CVSLE_staggerRamp) ){
+
+				report(eventFd, unit, CVSLE_busFull, 0);
+
+				fullAt=millis();
+
+			}//EOP load max
+			else if(lastState==CVSLE_staggerRamp){
+
+				report(eventFd, unit, CVSLE_busYield, 0);
+
+			}//EOP ramp stopped
+
+			lastState=state;
+
+		}//EOP state change
+
+		if( (fullAt>0) && ((millis()-fullAt)>CVSLE_busHoldMs) ){
+
+			break;
+
+		}//EOP done
+
+		usleep(50);
+
+	}//EOP loop
+
+	report(eventFd, unit, CVSLE_busExit, cvsStagger.getCollisionCount());
+
+	_exit(0);
+
+}//EOP runUnit
+
+
+//****************************
+//  Bus process
+//****************************
+
+static void usage(){
+
+	printf("staggerBus [options]\n");
+	printf("  -n units  units on the line (8, max %d)\n", CVSLE_busUnitsMax);
+	printf("  -i s      soft start interval of every unit (%d)\n", CVSLE_softStartInterval);
+	printf("  -x k      time runs k times faster than real time (10)\n");
+	printf("  -b baud   line baud rate for frame air time (19200)\n");
+	printf("  -j ms     spread of start requests after power restore (0)\n");
+	printf("  -t s      give up after s simulated seconds (300)\n");
+
+}//EOP usage
+
+
+int main(int argc, char **argv){
+
+	//Variables
+	int units=8;
+	int interval=CVSLE_softStartInterval;
+	unsigned long baud=19200;
+	unsigned long jitterMs=0;
+	unsigned long timeoutMs=300000;
+	int bus[CVSLE_busUnitsMax];
+	int events[2];
+	pid_t pids[CVSLE_busUnitsMax];
+	bool running[CVSLE_busUnitsMax];
+	bool full[CVSLE_busUnitsMax];
+	uint32_t rampAt[CVSLE_busUnitsMax];
+	uint32_t fullAt[CVSLE_busUnitsMax];
+	uint16_t collisions=0;
+	int ramps=0;
+	int rampsMax=0;
+	int exited=0;
+	uint8_t line[CVSLE_busBuffer];
+	int lineLength=0;
+	int lineOwner=-1;
+	bool lineGarbled=false;
+	uint64_t lineEnd=0;
+
+
+	//Step 1 => Options
+	for(int a=1;a<argc;a++){
+
+		const char *opt=argv[a];
+		const char *val=(a+1<argc) ? argv[a+1] : 0;
+
+		if(!strcmp(opt, "-help") || !strcmp(opt, "-h") || !val){
+
+			usage();
+
+			return (!strcmp(opt, "-help") || !strcmp(opt, "-h")) ? 0 : 1;
+
+		}//EOP help or missing value
+
+		a++;
+
+		if(!strcmp(opt, "-n")){ units=atoi(val); }
+		else if(!strcmp(opt, "-i")){ interval=atoi(val); }
+		else if(!strcmp(opt, "-x")){ speed=atof(val); }
+		else if(!strcmp(opt, "-b")){ baud=strtoul(val, 0, 10); }
+		else if(!strcmp(opt, "-j")){ jitterMs=strtoul(val, 0, 10); }
+		else if(!strcmp(opt, "-t")){ timeoutMs=strtoul(val, 0, 10)*1000; }
+		else{
+
+			usage();
+
+			return 1;
+
+		}//EOP unknown option
+
+	}//EOP options
+
+	if( (units<1) || (units>CVSLE_busUnitsMax) || (speed<=0) || (baud==0) ){
+
+		usage();
+
+		return 1;
+
+	}//EOP bad option
+
+
+	//Step 2 => Units, one socket each and a shared event pipe
+	signal(SIGPIPE, SIG_IGN);
+
+	if(pipe(events)<0){
+
+		perror("pipe");
+
+		return 1;
+
+	}//EOP pipe failed
+
+	for(int u=0;u<units;u++){
+
+		int pair[2];
+
+		if(socketpair(AF_UNIX, SOCK_STREAM, 0, pair)<0){
+
+			perror("socketpair");
+
+			return 1;
+
+		}//EOP socket failed
+
+		pids[u]=fork();
+
+		if(pids[u]==0){
+
+			close(pair[0]);
+			close(events[0]);
+
+			runUnit(u, pair[1], events[1], interval, jitterMs, timeoutMs);
+
+		}//EOP unit process
+
+		close(pair[1]);
+		bus[u]=pair[0];
+		running[u]=true;
+		full[u]=false;
+		rampAt[u]=0;
+		fullAt[u]=0;
+
+	}//EOP units
+
+	close(events[1]);
+
+	printf("time_ms,unit,event,ramps_running\n");
+
+	//Power restore, all units start now
+	clock_gettime(CLOCK_MONOTONIC, &epoch);
+
+	for(int u=0;u<units;u++){
+
+		uint8_t go=0;
+
+		send(bus[u], &go, 1, 0);
+
+	}//EOP units
+
+
+	//Step 3 => Bus and event log
+	while(exited<units){
+
+		struct pollfd fds[CVSLE_busUnitsMax+1];
+
+		for(int u=0;u<units;u++){
+
+			fds[u].fd=running[u] ? bus[u] : -1;
+			fds[u].events=POLLIN;
+
+		}//EOP unit sockets
+
+		fds[units].fd=events[0];
+		fds[units].events=POLLIN;
+
+		//Wake in time to end a frame on the line, else within 1 ms
+		uint64_t now=simMicros();
+		struct timespec wait={ 0, 1000000 };
+
+		if(lineOwner>=0){
+
+			wait.tv_nsec=(lineEnd>now) ? (long)((lineEnd-now)*1000/speed) : 0;
+
+			if(wait.tv_nsec>1000000){
+
+				wait.tv_nsec=1000000;
+
+			}//EOP cap
+
+		}//EOP frame on the line
+
+		ppoll(fds, units+1, &wait, 0);
+
+		now=simMicros();
+
+		//Bytes driven onto the line
+		for(int u=0;u<units;u++){
+
+			if(fds[u].revents & (POLLIN | POLLHUP)){
+
+				uint8_t data[CVSLE_busBuffer];
+				int count=recv(bus[u], data, sizeof(data), MSG_DONTWAIT);
+
+				if(count<=0){
+
+					running[u]=false;
+
+					continue;
+
+				}//EOP unit gone
+
+				//Another driver still on the line garbles both
+				if( (lineOwner>=0) && (lineOwner!=u) ){
+
+					lineGarbled=true;
+
+				}//EOP overlap
+
+				for(int i=0;(i<count) && (lineLength<CVSLE_busBuffer);i++){
+
+					line[lineLength++]=data[i];
+
+				}//EOP append
+
+				//Air time of 10 bits per byte
+				uint64_t end=now+((count*10*1000000ULL)/baud);
+
+				if( (lineOwner<0) || (end>lineEnd) ){
+
+					lineEnd=end;
+
+				}//EOP extend
+
+				lineOwner=u;
+
+			}//EOP unit sent
+
+		}//EOP unit sockets
+
+		//Line quiet again, every receiver sees what was on it
+		if( (lineOwner>=0) && (now>=lineEnd) ){
+
+			if(lineGarbled){
+
+				for(int i=0;i<lineLength;i++){
+
+					line[i]=line[i]^0x5A;
+
+				}//EOP garble
+
+			}//EOP collision
+
+			for(int u=0;u<units;u++){
+
+				if(running[u]){
+
+					send(bus[u], line, lineLength, MSG_DONTWAIT);
+
+				}//EOP unit listening
+
+			}//EOP receivers
+
+			lineLength=0;
+			lineOwner=-1;
+			lineGarbled=false;
+
+		}//EOP deliver
+
+		//Unit events
+		if(fds[units].revents & (POLLIN | POLLHUP)){
+
+			BusEvent event;
+
+			if(read(events[0], &event, sizeof(event))!=sizeof(event)){
+
+				break;
+
+			}//EOP all units closed
+
+			if(event.type==CVSLE_busRamp){
+
+				ramps++;
+				rampAt[event.unit]=event.ms;
+
+			}//EOP ramp
+			else if( (event.type==CVSLE_busFull) || (event.type==CVSLE_busYield) ){
+
+				ramps--;
+
+				if(event.type==CVSLE_busFull){
+
+					full[event.unit]=true;
+					fullAt[event.unit]=event.ms;
+
+				}//EOP load max
+
+			}//EOP ramp over
+			else if(event.type==CVSLE_busExit){
+
+				collisions+=event.value;
+				exited++;
+
+				continue;
+
+			}//EOP exit
+
+			if(ramps>rampsMax){
+
+				rampsMax=ramps;
+
+			}//EOP new peak
+
+			printf("%lu,%u,%c,%d\n", (unsigned long)event.ms, event.unit, event.type, ramps);
+
+		}//EOP event
+
+	}//EOP bus
+
+
+	//Step 4 => Summary
+	int fullCount=0;
+
+	fflush(stdout);
+
+	for(int u=0;u<units;u++){
+
+		waitpid(pids[u], 0, 0);
+
+		if(full[u]){
+
+			fullCount++;
+
+			fprintf(stderr, "unit %d ramp %lu ms to %lu ms\n", u, (unsigned long)rampAt[u], (unsigned long)fullAt[u]);
+
+		}//EOP reached load max
+		else{
+
+			fprintf(stderr, "unit %d never reached load max\n", u);
+
+		}//EOP timed out
+
+	}//EOP units
+
+	bool pass=( (fullCount==units) && (rampsMax<=CVSLE_staggerConcurrent) );
+
+	fprintf(stderr, "%d of %d units at load max, peak %d ramps at once (limit %d, unstaggered %d), %u claims lost: %s\n",
+			fullCount, units, rampsMax, CVSLE_staggerConcurrent, units, collisions, pass ? "PASS" : "FAIL");
+
+	return pass ? 0 : 1;
+
+}//EOP main
@@ -0,0 +1,108 @@
+/*
+ * telemetryDecoder.cpp
+ *
+ *
+ * Host side decoder for the CVSLE binary telemetry stream (CVSLETelemetry.h).
+ * Reads the raw byte stream on stdin, resynchronises on the sync bytes,
+ * checks the CRC and prints one CSV line per valid record.
+ *
+ * Build:  g++ -O2 -o telemetryDecoder telemetryDecoder.cpp
+ * Use:    stty -F /dev/ttyUSB0 115200 raw && ./telemetryDecoder < /dev/ttyUSB0
+ *
+ * Written by Ajay Sarathy/Arunmani G/Abdhulla Sheik for Saryam Eng Pvt Ltd.
+ * BSD license, all text above must be included in any redistribution
+ *
+ *  Created on: 18-Oct-2026
+ *      Author: Saryam Engineering Private Limited
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define CVSLE_telemetrySync0 0xA5 //First sync byte
+#define CVSLE_telemetrySync1 0x5A //Second sync byte
+#define CVSLE_telemetryPayload 7 //Record bytes covered by CRC
+#define CVSLE_ZDTickUs 16 //ZD timer tick in microseconds at 16MHz/256
+
+
+//Same as avr-libc _crc_ccitt_update
+static uint16_t crcCCITTUpdate(uint16_t crc, uint8_t data){
+
+	data^=(crc & 0xFF);
+	data^=data << 4;
+
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+
+}//EOP crcCCITTUpdate
+
+
+int main(){
+
+	//Variables
+	uint8_t record[CVSLE_telemetryPayload+2];
+	unsigned long good=0;
+	unsigned long bad=0;
+	unsigned long lost=0;
+	int previous=-1;
+	int c=0;
+	int last=-1;
+
+	printf("sequence,period_counts,half_cycle_ms,compare,state,fault,lost\n");
+
+	//Scan for sync bytes
+	while( (c=getchar())!=EOF ){
+
+		if( (last!=CVSLE_telemetrySync0) || (c!=CVSLE_telemetrySync1) ){
+
+			last=c;
+
+			continue;
+
+		}//EOP no sync
+
+		last=-1;
+
+		//Read payload and CRC
+		if(fread(record, 1, sizeof(record), stdin)!=sizeof(record)){
+
+			break;
+
+		}//EOP end of stream
+
+		uint16_t crc=0xFFFF;
+
+		for(int i=0;i<CVSLE_telemetryPayload;i++){
+
+			crc=crcCCITTUpdate(crc, record[i]);
+
+		}//EOP crc
+
+		if(crc!=(record[7] | (record[8] << 8))){
+
+			bad++;
+
+			continue;
+
+		}//EOP bad crc
+
+		good++;
+
+		//Sequence gap counts lost records
+		int sequence=record[0];
+		int gap=(previous<0)?0:((sequence-previous-1) & 0xFF);
+
+		lost+=gap;
+		previous=sequence;
+
+		unsigned period=record[1] | (record[2] << 8);
+		unsigned compare=record[3] | (record[4] << 8);
+
+		printf("%d,%u,%.3f,%u,0x%02X,0x%02X,%d\n", sequence, period, (period*CVSLE_ZDTickUs)/1000.0, compare, record[5], record[6], gap);
+
+	}//EOP stream
+
+	fprintf(stderr, "records %lu, crc errors %lu, lost %lu\n", good, bad, lost);
+
+	return 0;
+
+}//EOP main